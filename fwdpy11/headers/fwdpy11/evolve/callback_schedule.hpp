@@ -0,0 +1,131 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_EVOLVE_CALLBACK_SCHEDULE_HPP__
+#define FWDPY11_EVOLVE_CALLBACK_SCHEDULE_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+namespace fwdpy11
+{
+    class callback_schedule
+    /*!
+      Determines the generations in which a callback, such as a
+      recorder, is applied by an evolve function.
+
+      The schedule is a Python object, which is one of:
+
+      1. None, meaning every generation.
+      2. An int, s > 0, meaning every generation that is a multiple of s.
+      3. A NumPy array of bool, whose i-th element refers to the i-th
+      generation simulated by the evolve function.  Its length must equal
+      the number of generations simulated.
+      4. Any other sequence, which is interpreted as a list of
+      generations.  Values not simulated by the evolve function
+      are ignored.
+
+      The schedule is evaluated once, when an evolve function is called,
+      so that checking it costs nothing during the simulation.
+    */
+    {
+      private:
+        std::vector<std::uint8_t> mask;
+
+      public:
+        callback_schedule(pybind11::object schedule,
+                          const unsigned first_generation,
+                          const std::size_t generations)
+            /*!
+              \param schedule The schedule, as described above.
+              \param first_generation The value of pop.generation when
+              the first generation simulated is complete.
+              \param generations The number of generations to simulate.
+            */
+            : mask(generations, 0)
+        {
+            if (schedule == pybind11::none())
+                {
+                    std::fill(mask.begin(), mask.end(), 1);
+                }
+            else if (pybind11::isinstance<pybind11::int_>(schedule))
+                {
+                    const auto stride = schedule.cast<long long>();
+                    if (stride < 1)
+                        {
+                            throw std::invalid_argument(
+                                "schedule interval must be > 0");
+                        }
+                    for (std::size_t i = 0; i < generations; ++i)
+                        {
+                            mask[i] = ((first_generation + i) % stride == 0);
+                        }
+                }
+            else if (pybind11::isinstance<pybind11::array_t<bool>>(schedule))
+                {
+                    auto a = schedule.cast<pybind11::array_t<
+                        bool, pybind11::array::c_style
+                                  | pybind11::array::forcecast>>();
+                    if (a.ndim() != 1
+                        || static_cast<std::size_t>(a.size()) != generations)
+                        {
+                            throw std::invalid_argument(
+                                "length of boolean schedule must equal the "
+                                "number of generations simulated");
+                        }
+                    std::copy(a.data(), a.data() + generations, mask.begin());
+                }
+            else
+                {
+                    for (auto g : schedule.cast<std::vector<long long>>())
+                        {
+                            if (g < 0)
+                                {
+                                    throw std::invalid_argument(
+                                        "generations in a schedule must be "
+                                        "non-negative");
+                                }
+                            if (g >= first_generation
+                                && static_cast<std::size_t>(
+                                       g - first_generation)
+                                       < generations)
+                                {
+                                    mask[g - first_generation] = 1;
+                                }
+                        }
+                }
+        }
+
+        inline bool
+        operator()(const std::size_t i) const
+        /*!
+          Returns true if the callback is applied in the
+          i-th generation simulated.
+        */
+        {
+            return mask[i];
+        }
+    };
+}
+
+#endif
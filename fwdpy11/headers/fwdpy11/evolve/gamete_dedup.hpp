@@ -0,0 +1,179 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_EVOLVE_GAMETE_DEDUP_HPP__
+#define FWDPY11_EVOLVE_GAMETE_DEDUP_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include <fwdpp/forward_types.hpp>
+
+namespace fwdpy11
+{
+    class gamete_dedup_index
+    /*!
+      Index of the gametes extant in the parental generation and
+      those stored during the current generation, keyed on their
+      mutation keys.
+
+      Recombination frequently re-creates a haplotype that is
+      already present.  Without the index, each such recombinant
+      gets its own gamete.  With it, identical gametes share one
+      index, which reduces the number of gametes that have to be
+      stored, counted, and cleaned.
+
+      The index is keyed on a hash of the neutral and selected keys.
+      Candidates with equal hashes are compared key-by-key, so hash
+      collisions never merge different gametes.
+
+      Gametes are only valid entries for the generation in which
+      they are added, because gamete indexes are recycled and
+      fixations are removed from gametes between generations.
+      Thus, clear() must be called, and the extant gametes added,
+      at the start of each generation.  clear() keeps the
+      allocated storage.
+
+      If every recombinant is looked up, no two extant gametes
+      have the same keys, provided that this was true of the
+      parental generation.  Removing fixations does not change
+      this, because fixations are carried by every gamete.
+    */
+    {
+      public:
+        static constexpr std::size_t npos
+            = std::numeric_limits<std::size_t>::max();
+
+      private:
+        std::unordered_multimap<std::size_t, std::size_t> index;
+        //! Non-zero if a gamete has been added this generation
+        std::vector<std::uint8_t> added;
+
+        static inline std::size_t
+        combine(std::size_t seed, const std::size_t value)
+        {
+            seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+
+        static inline bool
+        same_keys(const std::vector<KTfwd::uint_t> &keys,
+                  const KTfwd::uint_t *beg, const KTfwd::uint_t *end)
+        {
+            return keys.size() == std::size_t(end - beg)
+                   && std::equal(beg, end, keys.begin());
+        }
+
+      public:
+        gamete_dedup_index() : index{}, added{} {}
+
+        void
+        clear()
+        {
+            index.clear();
+            std::fill(added.begin(), added.end(), 0);
+        }
+
+        static inline std::size_t
+        hash(const KTfwd::uint_t *neutral_begin,
+             const KTfwd::uint_t *neutral_end,
+             const KTfwd::uint_t *selected_begin,
+             const KTfwd::uint_t *selected_end)
+        {
+            // The lengths are hashed so that moving a key from one
+            // range to the other changes the hash.
+            std::size_t h
+                = combine(0, std::size_t(neutral_end - neutral_begin));
+            for (auto k = neutral_begin; k < neutral_end; ++k)
+                h = combine(h, *k);
+            h = combine(h, std::size_t(selected_end - selected_begin));
+            for (auto k = selected_begin; k < selected_end; ++k)
+                h = combine(h, *k);
+            return h;
+        }
+
+        template <typename gamete_t>
+        static inline bool
+        equal(const gamete_t &g, const KTfwd::uint_t *neutral_begin,
+              const KTfwd::uint_t *neutral_end,
+              const KTfwd::uint_t *selected_begin,
+              const KTfwd::uint_t *selected_end)
+        //! True if \a g contains exactly the given keys.
+        {
+            return same_keys(g.mutations, neutral_begin, neutral_end)
+                   && same_keys(g.smutations, selected_begin, selected_end);
+        }
+
+        template <typename gcont_t>
+        std::size_t
+        find(const gcont_t &gametes, const std::size_t h,
+             const KTfwd::uint_t *neutral_begin,
+             const KTfwd::uint_t *neutral_end,
+             const KTfwd::uint_t *selected_begin,
+             const KTfwd::uint_t *selected_end) const
+        /*!
+          Return the index of a gamete added this generation whose keys
+          hash to \a h and equal the given keys, or npos if there is
+          none.
+        */
+        {
+            const auto range = index.equal_range(h);
+            for (auto i = range.first; i != range.second; ++i)
+                {
+                    if (equal(gametes[i->second], neutral_begin, neutral_end,
+                              selected_begin, selected_end))
+                        {
+                            return i->second;
+                        }
+                }
+            return npos;
+        }
+
+        void
+        insert(const std::size_t h, const std::size_t gamete_index)
+        {
+            if (gamete_index >= added.size())
+                added.resize(gamete_index + 1, 0);
+            added[gamete_index] = 1;
+            index.emplace(h, gamete_index);
+        }
+
+        template <typename gcont_t>
+        void
+        insert(const gcont_t &gametes, const std::size_t gamete_index)
+        /*!
+          Add an existing gamete, unless it has already been
+          added this generation.
+        */
+        {
+            if (gamete_index < added.size() && added[gamete_index])
+                return;
+            const auto &g = gametes[gamete_index];
+            insert(hash(g.mutations.data(),
+                        g.mutations.data() + g.mutations.size(),
+                        g.smutations.data(),
+                        g.smutations.data() + g.smutations.size()),
+                   gamete_index);
+        }
+    };
+}
+
+#endif
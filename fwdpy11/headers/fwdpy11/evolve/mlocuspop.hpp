@@ -1,17 +1,138 @@
 #ifndef FWDPY11_EVOLVE_MLOCUSPOP_HPP__
 #define FWDPY11_EVOLVE_MLOCUSPOP_HPP__
 
+#include <functional>
+#include <stdexcept>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 #include <fwdpp/internal/gamete_cleaner.hpp>
 #include <fwdpp/insertion_policies.hpp>
 #include <fwdpp/recombination.hpp>
 #include <fwdpy11/types.hpp>
 #include <fwdpy11/samplers.hpp>
+#include <fwdpy11/thread_pool.hpp>
+#include <fwdpy11/evolve/offspring_staging.hpp>
 #include <gsl/gsl_randist.h>
 
 namespace fwdpy11
 {
+    template <typename poptype, typename locus_mutation_model,
+              typename queue_t, typename queue_t2>
+    inline std::size_t
+    store_locus_gamete(poptype& pop, const unsigned nm,
+                       const locus_mutation_model& mmodel,
+                       queue_t& mutation_recycling_bin,
+                       queue_t2& gamete_recycling_bin,
+                       std::vector<KTfwd::uint_t>& neutral,
+                       std::vector<KTfwd::uint_t>& selected)
+    /*!
+      Add \a nm new mutations from \a mmodel to the keys in
+      \a neutral and \a selected, and store the result as
+      a gamete with a count of one.
+    */
+    {
+        for (unsigned k = 0; k < nm; ++k)
+            {
+                auto key = mmodel(mutation_recycling_bin, pop.mutations);
+                insert_new_mutation_key(
+                    key, pop.mutations,
+                    pop.mutations[key].neutral ? neutral : selected);
+            }
+        return recycle_gamete(pop.gametes, gamete_recycling_bin,
+                              neutral.data(), neutral.data() + neutral.size(),
+                              selected.data(),
+                              selected.data() + selected.size());
+    }
+
+    template <typename poptype, typename mutation_model,
+              typename recombination_model, typename queue_t,
+              typename queue_t2>
+    void
+    multilocus_gamete(const gsl_rng* r, poptype& pop,
+                      const multilocus_diploid_t& parent, bool swap,
+                      const recombination_model& recmodel,
+                      const std::vector<std::function<unsigned(void)>>&
+                          interlocus_rec,
+                      const double* mu, const mutation_model& mmodel,
+                      queue_t& mutation_recycling_bin,
+                      queue_t2& gamete_recycling_bin,
+                      std::vector<KTfwd::uint_t>& neutral,
+                      std::vector<KTfwd::uint_t>& selected,
+                      multilocus_diploid_t& offspring, const bool first)
+    /*!
+      Write the gamete that \a parent transmits at each locus to
+      offspring[i].first, or to offspring[i].second if \a first
+      is false.  This replaces KTfwd::fwdpp_internal::multilocus_rec_mut,
+      which copies both parents and returns a new container of loci
+      for every offspring.
+
+      \a swap is the outcome of Mendel at the first locus.  The
+      parental gametes are switched at each subsequent locus for
+      an odd number of crossovers between, or within, loci.
+
+      Gamete counts must have been set to zero at the start of the
+      generation, and \a gamete_recycling_bin must only contain
+      gametes that were extinct at that time.
+    */
+    {
+        for (std::size_t i = 0; i < parent.size(); ++i)
+            {
+                if (i && interlocus_rec[i - 1]() % 2 != 0)
+                    swap = !swap;
+                auto g1 = parent[i].first, g2 = parent[i].second;
+                if (swap)
+                    std::swap(g1, g2);
+                const auto breakpoints
+                    = recmodel[i](pop.gametes[g1], pop.gametes[g2],
+                                  pop.mutations);
+                const auto nbreakpoints = count_crossovers(breakpoints);
+                if (nbreakpoints % 2 != 0)
+                    swap = !swap;
+                const unsigned nm
+                    = (mu[i] > 0.) ? gsl_ran_poisson(r, mu[i]) : 0u;
+                const bool recombinant = (nbreakpoints && g1 != g2);
+                std::size_t g = g1;
+                if (!recombinant && !nm)
+                    {
+                        pop.gametes[g1].n++;
+                    }
+                else
+                    {
+                        neutral.clear();
+                        selected.clear();
+                        if (recombinant)
+                            {
+                                merge_recombinant_keys(
+                                    breakpoints, pop.gametes[g1].mutations,
+                                    pop.gametes[g2].mutations, pop.mutations,
+                                    neutral);
+                                merge_recombinant_keys(
+                                    breakpoints, pop.gametes[g1].smutations,
+                                    pop.gametes[g2].smutations,
+                                    pop.mutations, selected);
+                            }
+                        else
+                            {
+                                neutral.assign(
+                                    pop.gametes[g1].mutations.begin(),
+                                    pop.gametes[g1].mutations.end());
+                                selected.assign(
+                                    pop.gametes[g1].smutations.begin(),
+                                    pop.gametes[g1].smutations.end());
+                            }
+                        g = store_locus_gamete(pop, nm, mmodel[i],
+                                               mutation_recycling_bin,
+                                               gamete_recycling_bin, neutral,
+                                               selected);
+                    }
+                if (first)
+                    offspring[i].first = g;
+                else
+                    offspring[i].second = g;
+            }
+    }
+
     template <typename poptype, typename pick1_function,
               typename pick2_function, typename update_function,
               typename mutation_model, typename recombination_model,
@@ -38,24 +159,31 @@ namespace fwdpy11
         for (auto&& g : pop.gametes)
             g.n = 0;
 
-        decltype(pop.diploids) offspring(N_next);
+        auto& offspring
+            = pop.offspring_buffer.reset(N_next, pop.diploids[0].size());
+        // Used when storing new gametes
+        std::vector<KTfwd::uint_t> neutral, selected;
 
         // Generate the offspring
-		std::size_t label = 0;
+        std::size_t label = 0;
         for (auto& dip : offspring)
             {
                 auto p1 = pick1(rng, pop);
                 auto p2 = pick2(rng, pop, p1);
 
-                dip = KTfwd::fwdpp_internal::multilocus_rec_mut(
-                    rng.get(), pop.diploids[p1], pop.diploids[p2],
-                    mutation_recycling_bin, gamete_recycling_bin, recmodel,
-                    interlocus_rec,
-                    ((gsl_rng_uniform(rng.get()) < 0.5) ? 1 : 0),
-                    ((gsl_rng_uniform(rng.get()) < 0.5) ? 1 : 0), pop.gametes,
-                    pop.mutations, pop.neutral, pop.selected, mu.data(),
-                    mmodel, KTfwd::emplace_back());
-				dip[0].label=label++;
+                const bool swap1 = (gsl_rng_uniform(rng.get()) < 0.5);
+                const bool swap2 = (gsl_rng_uniform(rng.get()) < 0.5);
+                multilocus_gamete(rng.get(), pop, pop.diploids[p1], swap1,
+                                  recmodel, interlocus_rec, mu.data(),
+                                  mmodel, mutation_recycling_bin,
+                                  gamete_recycling_bin, neutral, selected,
+                                  dip, true);
+                multilocus_gamete(rng.get(), pop, pop.diploids[p2], swap2,
+                                  recmodel, interlocus_rec, mu.data(),
+                                  mmodel, mutation_recycling_bin,
+                                  gamete_recycling_bin, neutral, selected,
+                                  dip, false);
+                dip[0].label = label++;
                 update(rng, dip, pop, p1, p2);
             }
 
@@ -64,7 +192,217 @@ namespace fwdpy11
         KTfwd::fwdpp_internal::gamete_cleaner(pop.gametes, pop.mutations,
                                               pop.mcounts, 2 * N_next, mrp,
                                               std::true_type());
-        // This is constant-time
+        // This is constant-time, and the parents become the offspring
+        // buffer of the next generation
+        pop.diploids.swap(offspring);
+    }
+
+    template <typename poptype, typename pick1_function,
+              typename pick2_function, typename update_function,
+              typename mutation_model, typename recombination_model,
+              typename mutation_removal_policy>
+    void
+    evolve_generation_threaded(
+        const GSLrng_t& rng, thread_pool& pool,
+        const std::vector<GSLrng_t>& thread_rngs,
+        const std::vector<recombination_model>& recmodels,
+        offspring_staging& staging, poptype& pop, const KTfwd::uint_t N_next,
+        const std::vector<double>& mu, const mutation_model& mmodel,
+        const std::vector<std::function<unsigned(void)>>& interlocus_rec,
+        const pick1_function& pick1, const pick2_function& pick2,
+        const update_function& update, const mutation_removal_policy& mrp)
+    /*!
+      Multi-threaded version of evolve_generation.
+
+      The generation proceeds in three stages:
+
+      1. Parents are chosen, and Mendel and interlocus
+         recombination are applied, serially, using \a rng.
+      2. Recombination within each locus and the number of new
+         mutations at each locus are generated in parallel for
+         blocks of offspring gametes.  Each thread uses its own
+         element of \a thread_rngs and \a recmodels and writes only
+         to its own block of \a staging.
+      3. New mutations are added, gametes are stored,
+         and offspring are updated, serially, in offspring order.
+
+      The k-th element of the per-gamete data in \a staging
+      refers to locus k % nloci of offspring gamete k / nloci.
+      The parents of offspring i are staging.parents[2*i]
+      and staging.parents[2*i+1].
+
+      Because the work assigned to each thread is a function of
+      N_next and pool.size() only, the output is reproducible
+      for a given seed and number of threads.
+
+      \note recmodels[i] must contain the per-locus recombination
+      models bound to thread_rngs[i].
+    */
+    {
+        static_assert(
+            std::is_same<typename poptype::popmodel_t,
+                         KTfwd::sugar::MULTILOCPOP_TAG>::value,
+            "Population type must be a multi-locus, single-deme type.");
+        if (thread_rngs.size() != pool.size()
+            || recmodels.size() != pool.size())
+            {
+                throw std::invalid_argument(
+                    "number of random number streams and recombination "
+                    "models must equal the number of threads");
+            }
+
+        auto gamete_recycling_bin
+            = KTfwd::fwdpp_internal::make_gamete_queue(pop.gametes);
+        auto mutation_recycling_bin
+            = KTfwd::fwdpp_internal::make_mut_queue(pop.mcounts);
+
+        for (auto&& g : pop.gametes)
+            g.n = 0;
+
+        const std::size_t nloci = pop.diploids[0].size();
+        staging.resize(std::size_t(N_next) * nloci, pool.size());
+
+        // Stage 1: parents, Mendel, and interlocus recombination.
+        // The parental gametes at each locus are stored in the
+        // order implied by these events alone.
+        for (std::size_t i = 0; i < N_next; ++i)
+            {
+                auto p1 = pick1(rng, pop);
+                auto p2 = pick2(rng, pop, p1);
+                staging.parents[2 * i] = p1;
+                staging.parents[2 * i + 1] = p2;
+                for (std::size_t j = 2 * i; j < 2 * i + 2; ++j)
+                    {
+                        const auto& parent
+                            = pop.diploids[staging.parents[j]];
+                        bool swap = (gsl_rng_uniform(rng.get()) < 0.5);
+                        for (std::size_t l = 0; l < nloci; ++l)
+                            {
+                                if (l && interlocus_rec[l - 1]() % 2 != 0)
+                                    swap = !swap;
+                                const auto k = j * nloci + l;
+                                auto g1 = parent[l].first,
+                                     g2 = parent[l].second;
+                                if (swap)
+                                    std::swap(g1, g2);
+                                staging.parental_gametes[2 * k] = g1;
+                                staging.parental_gametes[2 * k + 1] = g2;
+                            }
+                    }
+            }
+
+        // Stage 2: recombination within loci and mutation counts.
+        // An odd number of crossovers at a locus switches the
+        // parental gametes at all subsequent loci.
+        // Nothing in pop is modified here.
+        pool.run_blocks(2 * std::size_t(N_next), [&](const unsigned t,
+                                                      const std::size_t beg,
+                                                      const std::size_t end) {
+            const gsl_rng* r = thread_rngs[t].get();
+            const auto& recmodel = recmodels[t];
+            auto& keys = staging.arenas[t].keys;
+            keys.clear();
+            for (std::size_t j = beg; j < end; ++j)
+                {
+                    bool swap = false;
+                    for (std::size_t l = 0; l < nloci; ++l)
+                        {
+                            const auto k = j * nloci + l;
+                            auto& g1 = staging.parental_gametes[2 * k];
+                            auto& g2 = staging.parental_gametes[2 * k + 1];
+                            if (swap)
+                                std::swap(g1, g2);
+                            staging.recombined[k] = 0;
+                            const auto breakpoints
+                                = recmodel[l](pop.gametes[g1],
+                                              pop.gametes[g2], pop.mutations);
+                            const auto nbreakpoints
+                                = count_crossovers(breakpoints);
+                            if (nbreakpoints % 2 != 0)
+                                swap = !swap;
+                            if (nbreakpoints && g1 != g2)
+                                {
+                                    const auto offset = keys.size();
+                                    merge_recombinant_keys(
+                                        breakpoints,
+                                        pop.gametes[g1].mutations,
+                                        pop.gametes[g2].mutations,
+                                        pop.mutations, keys);
+                                    const auto nneutral
+                                        = keys.size() - offset;
+                                    merge_recombinant_keys(
+                                        breakpoints,
+                                        pop.gametes[g1].smutations,
+                                        pop.gametes[g2].smutations,
+                                        pop.mutations, keys);
+                                    staging.arena[k] = t;
+                                    staging.key_offset[k] = offset;
+                                    staging.nneutral[k] = nneutral;
+                                    staging.nselected[k]
+                                        = keys.size() - offset - nneutral;
+                                    staging.recombined[k] = 1;
+                                }
+                            staging.nmutations[k]
+                                = (mu[l] > 0.) ? gsl_ran_poisson(r, mu[l])
+                                               : 0u;
+                        }
+                }
+        });
+
+        // Stage 3: new mutations, gametes, and offspring
+        auto& neutral = staging.neutral;
+        auto& selected = staging.selected;
+        const auto finalize_gamete = [&](const std::size_t k,
+                                         const std::size_t l) {
+            const auto g1 = staging.parental_gametes[2 * k];
+            if (!staging.recombined[k] && !staging.nmutations[k])
+                {
+                    pop.gametes[g1].n++;
+                    return g1;
+                }
+            if (staging.recombined[k])
+                {
+                    const auto keys = staging.keys(k);
+                    const auto nend = keys + staging.nneutral[k];
+                    neutral.assign(keys, nend);
+                    selected.assign(nend, nend + staging.nselected[k]);
+                }
+            else
+                {
+                    neutral.assign(pop.gametes[g1].mutations.begin(),
+                                   pop.gametes[g1].mutations.end());
+                    selected.assign(pop.gametes[g1].smutations.begin(),
+                                    pop.gametes[g1].smutations.end());
+                }
+            return store_locus_gamete(pop, staging.nmutations[k], mmodel[l],
+                                      mutation_recycling_bin,
+                                      gamete_recycling_bin, neutral,
+                                      selected);
+        };
+
+        auto& offspring = pop.offspring_buffer.reset(N_next, nloci);
+        for (std::size_t i = 0; i < N_next; ++i)
+            {
+                auto& dip = offspring[i];
+                for (std::size_t l = 0; l < nloci; ++l)
+                    {
+                        dip[l].first = finalize_gamete(2 * i * nloci + l, l);
+                    }
+                for (std::size_t l = 0; l < nloci; ++l)
+                    {
+                        dip[l].second
+                            = finalize_gamete((2 * i + 1) * nloci + l, l);
+                    }
+                dip[0].label = i;
+                update(rng, dip, pop, staging.parents[2 * i],
+                       staging.parents[2 * i + 1]);
+            }
+
+        KTfwd::fwdpp_internal::process_gametes(pop.gametes, pop.mutations,
+                                               pop.mcounts);
+        KTfwd::fwdpp_internal::gamete_cleaner(pop.gametes, pop.mutations,
+                                              pop.mcounts, 2 * N_next, mrp,
+                                              std::true_type());
         pop.diploids.swap(offspring);
     }
 }
@@ -0,0 +1,197 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_EVOLVE_OFFSPRING_STAGING_HPP__
+#define FWDPY11_EVOLVE_OFFSPRING_STAGING_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <fwdpp/forward_types.hpp>
+
+namespace fwdpy11
+{
+    struct key_arena
+    /*!
+      Contiguous storage for the mutation keys of recombinant
+      gametes.  Each thread appends to its own arena, so that
+      the keys of all recombinants made by a thread occupy
+      a single block of memory.  Clearing an arena keeps its
+      capacity, so that there are no allocations once the
+      arena has grown to its working size.
+    */
+    {
+        std::vector<KTfwd::uint_t> keys;
+        key_arena() : keys{} {}
+    };
+
+    struct offspring_staging
+    /*!
+      Per-generation work space for the threaded evolve functions.
+
+      Offspring gametes are indexed 0 to 2N-1, with 2*i and 2*i+1
+      being the gametes of the i-th offspring.  The vectors are
+      kept between generations so that their capacity is re-used.
+
+      The keys of the j-th recombinant gamete are
+      arenas[arena[j]].keys[key_offset[j] + k], with the first
+      nneutral[j] being neutral and the next nselected[j]
+      being selected.
+    */
+    {
+        //! Indexes of the two parents of each offspring.
+        std::vector<std::size_t> parents;
+        //! The two parental gametes (after Mendel) of each offspring
+        //! gamete.
+        std::vector<std::size_t> parental_gametes;
+        //! One key arena per thread
+        std::vector<key_arena> arenas;
+        //! Location of the keys of each recombinant gamete
+        std::vector<std::size_t> key_offset;
+        std::vector<unsigned> arena, nneutral, nselected;
+        //! Non-zero if an offspring gamete is recombinant.
+        std::vector<std::uint8_t> recombined;
+        //! Number of new mutations per offspring gamete.
+        std::vector<unsigned> nmutations;
+        //! Used when adding new mutations to a gamete
+        std::vector<KTfwd::uint_t> neutral, selected;
+
+        offspring_staging()
+            : parents{}, parental_gametes{}, arenas{}, key_offset{},
+              arena{}, nneutral{}, nselected{}, recombined{}, nmutations{},
+              neutral{}, selected{}
+        {
+        }
+
+        void
+        resize(const std::size_t noffspring, const std::size_t nthreads)
+        {
+            parents.resize(2 * noffspring);
+            parental_gametes.resize(4 * noffspring);
+            arenas.resize(nthreads);
+            key_offset.resize(2 * noffspring);
+            arena.resize(2 * noffspring);
+            nneutral.resize(2 * noffspring);
+            nselected.resize(2 * noffspring);
+            recombined.resize(2 * noffspring);
+            nmutations.resize(2 * noffspring);
+        }
+
+        inline const KTfwd::uint_t *
+        keys(const std::size_t j) const
+        //! The first key of the j-th recombinant gamete
+        {
+            return arenas[arena[j]].keys.data() + key_offset[j];
+        }
+    };
+
+    inline unsigned
+    count_crossovers(const std::vector<double> &breakpoints)
+    /*!
+      The number of breakpoints, not counting the
+      terminating std::numeric_limits<double>::max()
+      returned by fwdpp's recombination models.
+    */
+    {
+        return static_cast<unsigned>(std::count_if(
+            breakpoints.begin(), breakpoints.end(), [](const double d) {
+                return d < std::numeric_limits<double>::max();
+            }));
+    }
+
+    template <typename mcont_t>
+    inline void
+    merge_recombinant_keys(const std::vector<double> &breakpoints,
+                           const std::vector<KTfwd::uint_t> &first,
+                           const std::vector<KTfwd::uint_t> &second,
+                           const mcont_t &mutations,
+                           std::vector<KTfwd::uint_t> &out)
+    /*!
+      Append the keys of the recombinant of \a first and \a second
+      to \a out.  The logic is identical to
+      KTfwd::recombine_gametes: mutations at positions <= a
+      breakpoint come from the current gamete, after which
+      we switch to the other one.
+    */
+    {
+        auto i = first.cbegin(), ie = first.cend();
+        auto j = second.cbegin(), je = second.cend();
+        const auto comp = [&mutations](const double value,
+                                       const KTfwd::uint_t key) {
+            return value < mutations[key].pos;
+        };
+        for (const double bp : breakpoints)
+            {
+                auto x = std::upper_bound(i, ie, bp, comp);
+                out.insert(out.end(), i, x);
+                i = x;
+                j = std::upper_bound(j, je, bp, comp);
+                std::swap(i, j);
+                std::swap(ie, je);
+            }
+        out.insert(out.end(), i, ie);
+    }
+
+    template <typename mcont_t>
+    inline void
+    insert_new_mutation_key(const KTfwd::uint_t key, const mcont_t &mutations,
+                            std::vector<KTfwd::uint_t> &keys)
+    /*!
+      Insert \a key into \a keys, keeping keys sorted by position.
+    */
+    {
+        const double pos = mutations[key].pos;
+        keys.insert(std::upper_bound(keys.begin(), keys.end(), pos,
+                                     [&mutations](const double value,
+                                                  const KTfwd::uint_t k) {
+                                         return value < mutations[k].pos;
+                                     }),
+                    key);
+    }
+
+    template <typename gcont_t, typename queue_t>
+    inline std::size_t
+    recycle_gamete(gcont_t &gametes, queue_t &gamete_recycling_bin,
+                   const KTfwd::uint_t *neutral_begin,
+                   const KTfwd::uint_t *neutral_end,
+                   const KTfwd::uint_t *selected_begin,
+                   const KTfwd::uint_t *selected_end)
+    /*!
+      Store a new gamete with count 1.  An extinct gamete is re-used
+      if one is available, in which case the keys are copied into
+      its existing vectors, re-using their capacity.
+    */
+    {
+        if (!gamete_recycling_bin.empty())
+            {
+                auto idx = gamete_recycling_bin.front();
+                gamete_recycling_bin.pop();
+                gametes[idx].n = 1;
+                gametes[idx].mutations.assign(neutral_begin, neutral_end);
+                gametes[idx].smutations.assign(selected_begin, selected_end);
+                return idx;
+            }
+        gametes.emplace_back(
+            1u, std::vector<KTfwd::uint_t>(neutral_begin, neutral_end),
+            std::vector<KTfwd::uint_t>(selected_begin, selected_end));
+        return gametes.size() - 1;
+    }
+}
+
+#endif
@@ -32,6 +32,18 @@ namespace fwdpy11
         const fwdpy11::multilocus_diploid_t &, const fwdpy11::multilocus_diploid_t &)>;
     using multilocus_aggregator_function
         = std::function<double(const pybind11::array_t<double>)>;
+
+    inline bool
+    native_trait_to_fitness(const trait_to_fitness_function &f)
+    /*!
+      True if \a f wraps a C++ function pointer, in which case it
+      may be called without holding the GIL.  pybind11 unwraps C++
+      functions exposed to Python in this way.  Anything else may be
+      a Python callable.
+    */
+    {
+        return f.target<double (*)(double, double)>() != nullptr;
+    }
 }
 
 #endif
@@ -0,0 +1,217 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_EVOLVE_RANDOM_DRAWS_HPP__
+#define FWDPY11_EVOLVE_RANDOM_DRAWS_HPP__
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <gsl/gsl_randist.h>
+#include <fwdpp/forward_types.hpp>
+#include <fwdpy11/rng.hpp>
+#include <fwdpy11/evolve/offspring_staging.hpp>
+#include <fwdpy11/evolve/recycling.hpp>
+
+namespace fwdpy11
+{
+    class offspring_draws
+    /*!
+      Random numbers used to generate offspring, drawn in blocks at
+      the start of each generation rather than one at a time while
+      offspring are generated.
+
+      Offspring gametes are indexed 0 to 2N-1, as in
+      offspring_staging.  For gamete j, mendel(j) is true if the
+      parent's gametes are swapped, and nmutations(j) is the
+      number of new mutations.  selfed(i) is true if the i-th
+      offspring is produced by selfing.
+
+      Mendel coin flips are bit-packed, with 32 flips per call to
+      gsl_rng_get.  Mutation counts are obtained by inversion from
+      a block of uniform deviates, which is generated without GSL's
+      dispatch for xoshiro256** (see fill_uniform).
+
+      The draws are made in a fixed order, so that results are
+      reproducible for a given seed, but they differ from those
+      obtained when drawing one at a time.
+    */
+    {
+      private:
+        std::vector<std::uint32_t> coins;
+        std::vector<std::uint8_t> selfed_;
+        std::vector<unsigned> nmutations_;
+        std::vector<double> uniforms;
+
+        //! Use gsl_ran_poisson for means at least this large
+        static constexpr double max_inversion_mean = 10.0;
+
+        void
+        fill_coins(const gsl_rng *r, const std::size_t nbits)
+        {
+            coins.resize((nbits + 31) / 32);
+            if (gsl_rng_min(r) == 0 && gsl_rng_max(r) == 0xffffffffUL)
+                {
+                    for (auto &c : coins)
+                        {
+                            c = static_cast<std::uint32_t>(gsl_rng_get(r));
+                        }
+                    return;
+                }
+            // Generators with fewer than 32 random bits per call
+            std::fill(coins.begin(), coins.end(), 0u);
+            for (std::size_t j = 0; j < nbits; ++j)
+                {
+                    if (gsl_rng_uniform(r) < 0.5)
+                        coins[j / 32] |= (std::uint32_t(1) << (j % 32));
+                }
+        }
+
+      public:
+        //! Used by add_new_mutations
+        std::vector<KTfwd::uint_t> neutral, selected;
+
+        offspring_draws()
+            : coins{}, selfed_{}, nmutations_{}, uniforms{}, neutral{},
+              selected{}
+        {
+        }
+
+        void
+        fill(const GSLrng_t &rng, const std::size_t N_next,
+             const double selfing_rate)
+        //! Draw the Mendel and selfing outcomes for N_next offspring
+        {
+            fill_coins(rng.get(), 2 * N_next);
+            selfed_.resize(N_next);
+            if (!(selfing_rate > 0.))
+                {
+                    std::fill(selfed_.begin(), selfed_.end(), 0);
+                }
+            else if (selfing_rate >= 1.)
+                {
+                    std::fill(selfed_.begin(), selfed_.end(), 1);
+                }
+            else
+                {
+                    uniforms.resize(N_next);
+                    fill_uniform(rng, uniforms.data(), N_next);
+                    for (std::size_t i = 0; i < N_next; ++i)
+                        {
+                            selfed_[i] = (uniforms[i] < selfing_rate);
+                        }
+                }
+        }
+
+        void
+        fill_mutations(const GSLrng_t &rng, const std::size_t N_next,
+                       const double mu)
+        //! Draw the number of new mutations for 2*N_next gametes
+        {
+            const std::size_t n = 2 * N_next;
+            nmutations_.resize(n);
+            if (!(mu > 0.))
+                {
+                    std::fill(nmutations_.begin(), nmutations_.end(), 0u);
+                    return;
+                }
+            if (mu >= max_inversion_mean)
+                {
+                    for (auto &m : nmutations_)
+                        {
+                            m = gsl_ran_poisson(rng.get(), mu);
+                        }
+                    return;
+                }
+            uniforms.resize(n);
+            fill_uniform(rng, uniforms.data(), n);
+            const double p0 = std::exp(-mu);
+            for (std::size_t j = 0; j < n; ++j)
+                {
+                    const double u = uniforms[j];
+                    unsigned k = 0;
+                    double p = p0, cdf = p0;
+                    // p > 0 guards against cdf rounding to below u
+                    while (u >= cdf && p > 0.)
+                        {
+                            ++k;
+                            p *= mu / k;
+                            cdf += p;
+                        }
+                    nmutations_[j] = k;
+                }
+        }
+
+        inline bool
+        mendel(const std::size_t j) const
+        {
+            return (coins[j / 32] >> (j % 32)) & 1u;
+        }
+
+        inline bool
+        selfed(const std::size_t i) const
+        {
+            return selfed_[i];
+        }
+
+        inline unsigned
+        nmutations(const std::size_t j) const
+        {
+            return nmutations_[j];
+        }
+    };
+
+    template <typename poptype, typename mutation_model>
+    inline std::size_t
+    add_new_mutations(const unsigned nmutations, const std::size_t g,
+                      poptype &pop, recycling_bins &bins,
+                      const mutation_model &mmodel, offspring_draws &draws)
+    /*!
+      Equivalent to KTfwd::mutate_gamete_recycle, except that the
+      number of new mutations has already been drawn.
+      The count of gamete \a g must include the offspring,
+      and the returned gamete must be passed to bins.created().
+    */
+    {
+        if (!nmutations)
+            return g;
+        assert(pop.gametes[g].n);
+        pop.gametes[g].n--;
+        auto &neutral = draws.neutral;
+        auto &selected = draws.selected;
+        neutral.assign(pop.gametes[g].mutations.begin(),
+                       pop.gametes[g].mutations.end());
+        selected.assign(pop.gametes[g].smutations.begin(),
+                        pop.gametes[g].smutations.end());
+        for (unsigned k = 0; k < nmutations; ++k)
+            {
+                auto key = mmodel(bins.mutations, pop.mutations);
+                insert_new_mutation_key(
+                    key, pop.mutations,
+                    pop.mutations[key].neutral ? neutral : selected);
+            }
+        return recycle_gamete(pop.gametes, bins.gametes, neutral.data(),
+                              neutral.data() + neutral.size(),
+                              selected.data(),
+                              selected.data() + selected.size());
+    }
+}
+
+#endif
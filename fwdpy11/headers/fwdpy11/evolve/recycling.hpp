@@ -0,0 +1,330 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_EVOLVE_RECYCLING_HPP__
+#define FWDPY11_EVOLVE_RECYCLING_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <vector>
+#include <fwdpp/forward_types.hpp>
+
+namespace fwdpy11
+{
+    class recycling_bins
+    /*!
+      Persistent recycling bins for gametes and mutations.
+
+      fwdpp's make_gamete_queue and make_mut_queue scan the entire
+      gamete and mutation containers at the start of each generation,
+      and every gamete count is set to zero before offspring are
+      generated.  Here, the bins are built once, when the object is
+      constructed, and are then updated using only the gametes and
+      mutations that were extant in, or created during, the previous
+      generation.
+
+      Mutation counts are also updated incrementally.  See
+      process_gametes().
+
+      Gamete counts are stamped with the generation in which they
+      were last set.  transmit() resets a stale count before
+      incrementing it, and end_generation() sets the counts of
+      gametes that were not transmitted to zero.  Thus, gamete
+      counts are only valid after end_generation().
+
+      An instance is only valid for a single call to an evolve
+      function, because the population may be modified from
+      Python between calls.
+
+      \note The bins are std::queue<std::size_t>, which is the type
+      used by fwdpp's mutation models and recycling functions.
+    */
+    {
+      public:
+        using queue_t = std::queue<std::size_t>;
+        queue_t gametes, mutations;
+
+      private:
+        //! Gametes with a non-zero count in the previous generation
+        std::vector<std::size_t> extant_gametes;
+        //! Gametes transmitted or created in the current generation
+        std::vector<std::size_t> current_gametes;
+        std::vector<unsigned long> stamps;
+        unsigned long stamp;
+        //! The contents of the mutations bin, in the same order.
+        //! Elements before free_head have been taken by mutation
+        //! models.
+        std::vector<std::size_t> free_mutations;
+        std::size_t free_head;
+        //! Mutations that may have a non-zero count
+        std::vector<std::size_t> candidates;
+        //! Candidates whose count is zero, or became 2N
+        std::vector<std::size_t> changed;
+        //! Non-zero for mutations whose count was 2N in the
+        //! previous call to process_gametes
+        std::vector<std::uint8_t> at_twoN;
+        bool fixed;
+        //! Size of the mutation container when the bin was last filled
+        std::size_t nmutations;
+
+        inline void
+        stamp_gamete(const std::size_t g)
+        {
+            if (g >= stamps.size())
+                stamps.resize(g + 1, 0);
+            stamps[g] = stamp;
+            current_gametes.push_back(g);
+        }
+
+        inline void
+        free_mutation(const std::size_t k)
+        {
+            mutations.push(k);
+            free_mutations.push_back(k);
+            if (k < at_twoN.size())
+                at_twoN[k] = 0;
+        }
+
+      public:
+        template <typename poptype>
+        explicit recycling_bins(const poptype &pop)
+            : gametes{}, mutations{}, extant_gametes{}, current_gametes{},
+              stamps(pop.gametes.size(), 0), stamp(0), free_mutations{},
+              free_head(0), candidates{}, changed{}, at_twoN{}, fixed(false),
+              nmutations(pop.mutations.size())
+        {
+            for (std::size_t i = 0; i < pop.gametes.size(); ++i)
+                {
+                    if (pop.gametes[i].n)
+                        extant_gametes.push_back(i);
+                    else
+                        gametes.push(i);
+                }
+            for (std::size_t i = 0; i < pop.mcounts.size(); ++i)
+                {
+                    if (pop.mcounts[i])
+                        candidates.push_back(i);
+                    else
+                        free_mutation(i);
+                }
+            // Mutations without a count have never been
+            // counted, and must be checked after the first generation.
+            for (std::size_t i = pop.mcounts.size(); i < nmutations; ++i)
+                {
+                    candidates.push_back(i);
+                }
+        }
+
+        const std::vector<std::size_t> &
+        extant() const
+        /*!
+          Gametes with a non-zero count in the previous generation.
+          Only valid between start_generation() and end_generation().
+        */
+        {
+            return extant_gametes;
+        }
+
+        inline void
+        start_generation()
+        {
+            ++stamp;
+            current_gametes.clear();
+        }
+
+        template <typename gcont_t>
+        inline void
+        transmit(gcont_t &gcont, const std::size_t g)
+        //! Increment the count of gamete g.
+        {
+            if (g >= stamps.size() || stamps[g] != stamp)
+                {
+                    stamp_gamete(g);
+                    gcont[g].n = 0;
+                }
+            ++gcont[g].n;
+        }
+
+        inline void
+        created(const std::size_t g)
+        /*!
+          Record gamete g, whose count has already been set,
+          for example by a fwdpp function or by recycle_gamete.
+        */
+        {
+            if (g >= stamps.size() || stamps[g] != stamp)
+                stamp_gamete(g);
+        }
+
+        template <typename gcont_t>
+        void
+        end_generation(gcont_t &gcont)
+        /*!
+          Set the counts of gametes that were not transmitted
+          to zero, and add them, and any gamete whose count fell
+          to zero during the generation, to the gamete bin.
+        */
+        {
+            for (auto g : extant_gametes)
+                {
+                    if (stamps[g] != stamp)
+                        {
+                            gcont[g].n = 0;
+                            gametes.push(g);
+                        }
+                }
+            extant_gametes.clear();
+            for (auto g : current_gametes)
+                {
+                    if (gcont[g].n)
+                        extant_gametes.push_back(g);
+                    else
+                        gametes.push(g);
+                }
+        }
+
+        template <typename gcont_t>
+        void
+        process_gametes(const gcont_t &gcont, const std::size_t mutations_size,
+                        std::vector<KTfwd::uint_t> &mcounts,
+                        const KTfwd::uint_t twoN)
+        /*!
+          Replaces KTfwd::fwdpp_internal::process_gametes, which
+          zeroes every element of mcounts and then visits every
+          gamete.  Here, only the counts of candidate mutations
+          are zeroed, and only extant gametes are visited.
+          Must be called after end_generation().
+
+          Candidates whose counts are zero are recorded, and are
+          returned by changed_mutations().  So are candidates whose
+          counts are \a twoN, but only in the first call in which
+          that is true.  Selected fixations that are retained in the
+          population, e.g. in simulations of quantitative traits,
+          therefore do not cause any_fixed() to return true in every
+          subsequent generation.
+        */
+        {
+            mutation_candidates(mutations_size);
+            mcounts.resize(mutations_size, 0);
+            for (auto k : candidates)
+                mcounts[k] = 0;
+            for (auto g : extant_gametes)
+                {
+                    const auto n = gcont[g].n;
+                    for (auto k : gcont[g].mutations)
+                        mcounts[k] += n;
+                    for (auto k : gcont[g].smutations)
+                        mcounts[k] += n;
+                }
+            changed.clear();
+            fixed = false;
+            if (at_twoN.size() < mutations_size)
+                at_twoN.resize(mutations_size, 0);
+            for (auto k : candidates)
+                {
+                    if (mcounts[k] == twoN)
+                        {
+                            if (!at_twoN[k])
+                                {
+                                    changed.push_back(k);
+                                    fixed = true;
+                                }
+                            at_twoN[k] = 1;
+                        }
+                    else
+                        {
+                            if (mcounts[k] == 0)
+                                changed.push_back(k);
+                            at_twoN[k] = 0;
+                        }
+                }
+        }
+
+        inline bool
+        any_fixed() const
+        //! True if any mutation was fixed in the last call to process_gametes
+        {
+            return fixed;
+        }
+
+        const std::vector<std::size_t> &
+        changed_mutations() const
+        /*!
+          Mutations that were lost or fixed in the last call
+          to process_gametes.  All other mutations have counts
+          in (0, 2N), were extinct before that generation, or
+          were fixed in an earlier generation and retained.
+        */
+        {
+            return changed;
+        }
+
+        const std::vector<std::size_t> &
+        mutation_candidates(const std::size_t mutations_size)
+        /*!
+          Return the keys of all mutations that may have a non-zero
+          count, which are those that did in the previous generation
+          plus those created by the mutation model since then.
+          The latter were either taken from the mutation bin
+          or appended to a mutation container of size
+          \a mutations_size.
+        */
+        {
+            const std::size_t ntaken
+                = free_mutations.size() - free_head - mutations.size();
+            candidates.insert(candidates.end(),
+                              free_mutations.begin() + free_head,
+                              free_mutations.begin() + free_head + ntaken);
+            free_head += ntaken;
+            for (std::size_t i = nmutations; i < mutations_size; ++i)
+                {
+                    candidates.push_back(i);
+                }
+            nmutations = mutations_size;
+            return candidates;
+        }
+
+        void
+        recycle_mutations(const std::vector<KTfwd::uint_t> &mcounts)
+        /*!
+          Add candidates with a count of zero to the mutation bin.
+          Must be called after process_gametes() and after
+          fixations have been removed from mcounts.
+        */
+        {
+            if (free_head > free_mutations.size() / 2)
+                {
+                    free_mutations.erase(free_mutations.begin(),
+                                         free_mutations.begin() + free_head);
+                    free_head = 0;
+                }
+            std::size_t nextant = 0;
+            for (auto k : candidates)
+                {
+                    if (mcounts[k])
+                        candidates[nextant++] = k;
+                    else
+                        free_mutation(k);
+                }
+            candidates.resize(nextant);
+        }
+    };
+}
+
+#endif
@@ -3,11 +3,17 @@
 
 #include <tuple>
 #include <type_traits>
+#include <vector>
 #include <fwdpp/internal/gamete_cleaner.hpp>
 #include <fwdpp/insertion_policies.hpp>
 #include <fwdpp/recombination.hpp>
 #include <fwdpy11/types.hpp>
 #include <fwdpy11/samplers.hpp>
+#include <fwdpy11/thread_pool.hpp>
+#include <fwdpy11/evolve/offspring_staging.hpp>
+#include <fwdpy11/evolve/gamete_dedup.hpp>
+#include <fwdpy11/evolve/recycling.hpp>
+#include <fwdpy11/evolve/random_draws.hpp>
 #include <gsl/gsl_randist.h>
 
 namespace fwdpy11
@@ -17,40 +23,44 @@ namespace fwdpy11
               typename mutation_model, typename recombination_model,
               typename mutation_removal_policy>
     void
-    evolve_generation(const GSLrng_t& rng, poptype& pop,
+    evolve_generation(const GSLrng_t& rng, poptype& pop, recycling_bins& bins,
                       const KTfwd::uint_t N_next, const double mu,
                       const mutation_model& mmodel,
                       const recombination_model& recmodel,
                       const pick1_function& pick1, const pick2_function& pick2,
                       const update_function& update,
-                      const mutation_removal_policy& mrp)
+                      const mutation_removal_policy& mrp,
+                      offspring_draws* draws = nullptr)
+    /*!
+      Generate the next generation of a single-locus population.
+      \a bins must have been constructed from \a pop, and it must
+      be passed to each generation of the same call to an evolve
+      function.
+
+      If \a draws is not nullptr, the Mendel, selfing, and mutation
+      draws are made in blocks before offspring are generated.
+      In that case, \a draws must have been filled for N_next
+      offspring, and \a pick2 must not self.
+    */
     {
         static_assert(
             std::is_same<typename poptype::popmodel_t,
                          KTfwd::sugar::SINGLEPOP_TAG>::value,
             "Population type must be a single-locus, single-deme type.");
 
-        auto gamete_recycling_bin
-            = KTfwd::fwdpp_internal::make_gamete_queue(pop.gametes);
-        auto mutation_recycling_bin
-            = KTfwd::fwdpp_internal::make_mut_queue(pop.mcounts);
-
-        // Efficiency hit.  Unavoidable
-        // in use case of a sampler looking
-        // at the gametes themselves (even tho
-        // gamete.n has little bearing on anything
-        // beyond recycling).  Can revisit later
-        for (auto&& g : pop.gametes)
-            g.n = 0;
+        bins.start_generation();
 
-        decltype(pop.diploids) offspring(N_next);
+        auto& offspring = pop.offspring_buffer.reset(N_next);
 
         // Generate the offspring
         std::size_t label = 0;
         for (auto& dip : offspring)
             {
+                const std::size_t i = label;
                 auto p1 = pick1(rng, pop);
-                auto p2 = pick2(rng, pop, p1);
+                auto p2 = (draws != nullptr && draws->selfed(i))
+                              ? p1
+                              : pick2(rng, pop, p1);
 
                 auto p1g1 = pop.diploids[p1].first;
                 auto p1g2 = pop.diploids[p1].second;
@@ -58,34 +68,58 @@ namespace fwdpy11
                 auto p2g2 = pop.diploids[p2].second;
 
                 // Mendel
-                if (gsl_rng_uniform(rng.get()) < 0.5)
-                    std::swap(p1g1, p1g2);
-                if (gsl_rng_uniform(rng.get()) < 0.5)
-                    std::swap(p2g1, p2g2);
+                if (draws != nullptr)
+                    {
+                        if (draws->mendel(2 * i))
+                            std::swap(p1g1, p1g2);
+                        if (draws->mendel(2 * i + 1))
+                            std::swap(p2g1, p2g2);
+                    }
+                else
+                    {
+                        if (gsl_rng_uniform(rng.get()) < 0.5)
+                            std::swap(p1g1, p1g2);
+                        if (gsl_rng_uniform(rng.get()) < 0.5)
+                            std::swap(p2g1, p2g2);
+                    }
 
                 dip.first
-                    = KTfwd::recombination(pop.gametes, gamete_recycling_bin,
+                    = KTfwd::recombination(pop.gametes, bins.gametes,
                                            pop.neutral, pop.selected, recmodel,
                                            p1g1, p1g2, pop.mutations)
                           .first;
                 dip.second
-                    = KTfwd::recombination(pop.gametes, gamete_recycling_bin,
+                    = KTfwd::recombination(pop.gametes, bins.gametes,
                                            pop.neutral, pop.selected, recmodel,
                                            p2g1, p2g2, pop.mutations)
                           .first;
 
-                pop.gametes[dip.first].n++;
-                pop.gametes[dip.second].n++;
+                bins.transmit(pop.gametes, dip.first);
+                bins.transmit(pop.gametes, dip.second);
 
                 // now, add new mutations
-                dip.first = KTfwd::mutate_gamete_recycle(
-                    mutation_recycling_bin, gamete_recycling_bin, rng.get(),
-                    mu, pop.gametes, pop.mutations, dip.first, mmodel,
-                    KTfwd::emplace_back());
-                dip.second = KTfwd::mutate_gamete_recycle(
-                    mutation_recycling_bin, gamete_recycling_bin, rng.get(),
-                    mu, pop.gametes, pop.mutations, dip.second, mmodel,
-                    KTfwd::emplace_back());
+                if (draws != nullptr)
+                    {
+                        dip.first = add_new_mutations(
+                            draws->nmutations(2 * i), dip.first, pop, bins,
+                            mmodel, *draws);
+                        dip.second = add_new_mutations(
+                            draws->nmutations(2 * i + 1), dip.second, pop,
+                            bins, mmodel, *draws);
+                    }
+                else
+                    {
+                        dip.first = KTfwd::mutate_gamete_recycle(
+                            bins.mutations, bins.gametes, rng.get(), mu,
+                            pop.gametes, pop.mutations, dip.first, mmodel,
+                            KTfwd::emplace_back());
+                        dip.second = KTfwd::mutate_gamete_recycle(
+                            bins.mutations, bins.gametes, rng.get(), mu,
+                            pop.gametes, pop.mutations, dip.second, mmodel,
+                            KTfwd::emplace_back());
+                    }
+                bins.created(dip.first);
+                bins.created(dip.second);
 
                 assert(pop.gametes[dip.first].n);
                 assert(pop.gametes[dip.second].n);
@@ -93,11 +127,285 @@ namespace fwdpy11
                 update(rng, dip, pop, p1, p2);
             }
 
-        KTfwd::fwdpp_internal::process_gametes(pop.gametes, pop.mutations,
-                                               pop.mcounts);
-        KTfwd::fwdpp_internal::gamete_cleaner(pop.gametes, pop.mutations,
-                                              pop.mcounts, 2 * N_next, mrp);
-        // This is constant-time
+        bins.end_generation(pop.gametes);
+        bins.process_gametes(pop.gametes, pop.mutations.size(), pop.mcounts,
+                             2 * N_next);
+        // gamete_cleaner searches all of mcounts for fixations
+        if (bins.any_fixed())
+            {
+                KTfwd::fwdpp_internal::gamete_cleaner(
+                    pop.gametes, pop.mutations, pop.mcounts, 2 * N_next, mrp);
+            }
+        // This is constant-time, and the parents become the offspring
+        // buffer of the next generation
+        pop.diploids.swap(offspring);
+    }
+
+    template <typename poptype, typename pick1_function,
+              typename pick2_function, typename update_function,
+              typename mutation_model, typename recombination_model,
+              typename mutation_removal_policy>
+    void
+    evolve_generation_threaded(
+        const GSLrng_t& rng, thread_pool& pool,
+        const std::vector<GSLrng_t>& thread_rngs,
+        const std::vector<recombination_model>& recmodels,
+        offspring_staging& staging, poptype& pop, recycling_bins& bins,
+        const KTfwd::uint_t N_next,
+        const double mu, const mutation_model& mmodel,
+        const pick1_function& pick1, const pick2_function& pick2,
+        const update_function& update, const mutation_removal_policy& mrp,
+        gamete_dedup_index* dedup = nullptr, offspring_draws* draws = nullptr)
+    /*!
+      Multi-threaded version of evolve_generation.
+
+      The generation proceeds in three stages:
+
+      1. Parents are chosen and Mendel is applied, serially,
+         using \a rng.
+      2. Recombinant gametes and the number of new mutations
+         per offspring gamete are generated in parallel.
+         Each thread uses its own element of \a thread_rngs and
+         \a recmodels and writes only to its own block of \a staging.
+      3. New mutations are added, gametes are stored,
+         and offspring are updated, serially, in offspring order.
+
+      Because the work assigned to each thread is a function of
+      N_next and pool.size() only, the output is reproducible
+      for a given seed and number of threads.
+
+      If \a dedup is not nullptr, a recombinant gamete without new
+      mutations that is identical to a gamete extant in the parental
+      generation, or created for an offspring in this generation,
+      re-uses that gamete rather than storing a new one.  Because
+      stage 3 is serial, this does not affect reproducibility.
+      Gametes with new mutations cannot equal an existing gamete,
+      so no two extant gametes are identical if that was true of
+      the parental generation.
+
+      If \a draws is not nullptr, stage 1 uses its Mendel and
+      selfing draws, as in evolve_generation.  The number of new
+      mutations is always drawn in stage 2.
+
+      \note recmodels[i] must be bound to thread_rngs[i].
+    */
+    {
+        static_assert(
+            std::is_same<typename poptype::popmodel_t,
+                         KTfwd::sugar::SINGLEPOP_TAG>::value,
+            "Population type must be a single-locus, single-deme type.");
+        if (thread_rngs.size() != pool.size()
+            || recmodels.size() != pool.size())
+            {
+                throw std::invalid_argument(
+                    "number of random number streams and recombination "
+                    "models must equal the number of threads");
+            }
+
+        staging.resize(N_next, pool.size());
+
+        // Stage 1: parents and Mendel
+        for (std::size_t i = 0; i < N_next; ++i)
+            {
+                auto p1 = pick1(rng, pop);
+                auto p2 = (draws != nullptr && draws->selfed(i))
+                              ? p1
+                              : pick2(rng, pop, p1);
+
+                auto p1g1 = pop.diploids[p1].first;
+                auto p1g2 = pop.diploids[p1].second;
+                auto p2g1 = pop.diploids[p2].first;
+                auto p2g2 = pop.diploids[p2].second;
+
+                if (draws != nullptr)
+                    {
+                        if (draws->mendel(2 * i))
+                            std::swap(p1g1, p1g2);
+                        if (draws->mendel(2 * i + 1))
+                            std::swap(p2g1, p2g2);
+                    }
+                else
+                    {
+                        if (gsl_rng_uniform(rng.get()) < 0.5)
+                            std::swap(p1g1, p1g2);
+                        if (gsl_rng_uniform(rng.get()) < 0.5)
+                            std::swap(p2g1, p2g2);
+                    }
+
+                staging.parents[2 * i] = p1;
+                staging.parents[2 * i + 1] = p2;
+                staging.parental_gametes[4 * i] = p1g1;
+                staging.parental_gametes[4 * i + 1] = p1g2;
+                staging.parental_gametes[4 * i + 2] = p2g1;
+                staging.parental_gametes[4 * i + 3] = p2g2;
+            }
+
+        // Stage 2: recombination and mutation counts.
+        // Nothing in pop is modified here.
+        pool.run_blocks(2 * std::size_t(N_next), [&](const unsigned t,
+                                                      const std::size_t beg,
+                                                      const std::size_t end) {
+            const gsl_rng* r = thread_rngs[t].get();
+            const auto& recmodel = recmodels[t];
+            auto& keys = staging.arenas[t].keys;
+            keys.clear();
+            for (std::size_t j = beg; j < end; ++j)
+                {
+                    const auto g1 = staging.parental_gametes[2 * j];
+                    const auto g2 = staging.parental_gametes[2 * j + 1];
+                    staging.recombined[j] = 0;
+                    if (g1 != g2)
+                        {
+                            const auto breakpoints = recmodel(
+                                pop.gametes[g1], pop.gametes[g2],
+                                pop.mutations);
+                            if (count_crossovers(breakpoints))
+                                {
+                                    const auto offset = keys.size();
+                                    merge_recombinant_keys(
+                                        breakpoints,
+                                        pop.gametes[g1].mutations,
+                                        pop.gametes[g2].mutations,
+                                        pop.mutations, keys);
+                                    const auto nneutral
+                                        = keys.size() - offset;
+                                    merge_recombinant_keys(
+                                        breakpoints,
+                                        pop.gametes[g1].smutations,
+                                        pop.gametes[g2].smutations,
+                                        pop.mutations, keys);
+                                    staging.arena[j] = t;
+                                    staging.key_offset[j] = offset;
+                                    staging.nneutral[j] = nneutral;
+                                    staging.nselected[j]
+                                        = keys.size() - offset - nneutral;
+                                    staging.recombined[j] = 1;
+                                }
+                        }
+                    staging.nmutations[j]
+                        = (mu > 0.) ? gsl_ran_poisson(r, mu) : 0u;
+                }
+        });
+
+        bins.start_generation();
+        if (dedup != nullptr)
+            {
+                dedup->clear();
+                for (auto g : bins.extant())
+                    dedup->insert(pop.gametes, g);
+            }
+
+        const auto store_gamete = [&](const KTfwd::uint_t* neutral_begin,
+                                      const KTfwd::uint_t* neutral_end,
+                                      const KTfwd::uint_t* selected_begin,
+                                      const KTfwd::uint_t* selected_end) {
+            const auto idx
+                = recycle_gamete(pop.gametes, bins.gametes, neutral_begin,
+                                 neutral_end, selected_begin, selected_end);
+            bins.created(idx);
+            return idx;
+        };
+
+        const auto store_recombinant = [&](const std::size_t j) {
+            // Copy the recombinant directly from its arena
+            const auto keys = staging.keys(j);
+            const auto nn = staging.nneutral[j];
+            const auto nend = keys + nn, send = nend + staging.nselected[j];
+            if (dedup == nullptr)
+                {
+                    return store_gamete(keys, nend, nend, send);
+                }
+            // A recombinant may be identical to one of its parents,
+            // which are already in the index
+            for (std::size_t p = 2 * j; p < 2 * j + 2; ++p)
+                {
+                    const auto g = staging.parental_gametes[p];
+                    if (gamete_dedup_index::equal(pop.gametes[g], keys, nend,
+                                                  nend, send))
+                        {
+                            bins.transmit(pop.gametes, g);
+                            return g;
+                        }
+                }
+            const auto h = gamete_dedup_index::hash(keys, nend, nend, send);
+            auto idx
+                = dedup->find(pop.gametes, h, keys, nend, nend, send);
+            if (idx != gamete_dedup_index::npos)
+                {
+                    bins.transmit(pop.gametes, idx);
+                    return idx;
+                }
+            idx = store_gamete(keys, nend, nend, send);
+            dedup->insert(h, idx);
+            return idx;
+        };
+
+        const auto finalize_gamete = [&](const std::size_t j) {
+            const auto g1 = staging.parental_gametes[2 * j];
+            if (!staging.recombined[j] && !staging.nmutations[j])
+                {
+                    bins.transmit(pop.gametes, g1);
+                    return g1;
+                }
+            if (!staging.nmutations[j])
+                {
+                    return store_recombinant(j);
+                }
+            auto& neutral = staging.neutral;
+            auto& selected = staging.selected;
+            if (staging.recombined[j])
+                {
+                    const auto keys = staging.keys(j);
+                    const auto nn = staging.nneutral[j];
+                    neutral.assign(keys, keys + nn);
+                    selected.assign(keys + nn,
+                                    keys + nn + staging.nselected[j]);
+                }
+            else
+                {
+                    neutral.assign(pop.gametes[g1].mutations.begin(),
+                                   pop.gametes[g1].mutations.end());
+                    selected.assign(pop.gametes[g1].smutations.begin(),
+                                    pop.gametes[g1].smutations.end());
+                }
+            for (unsigned k = 0; k < staging.nmutations[j]; ++k)
+                {
+                    auto key = mmodel(bins.mutations, pop.mutations);
+                    insert_new_mutation_key(
+                        key, pop.mutations,
+                        pop.mutations[key].neutral ? neutral : selected);
+                }
+            return store_gamete(neutral.data(),
+                                neutral.data() + neutral.size(),
+                                selected.data(),
+                                selected.data() + selected.size());
+        };
+
+        auto& offspring = pop.offspring_buffer.reset(N_next);
+
+        // Stage 3: new mutations, gametes, and offspring
+        std::size_t label = 0;
+        for (std::size_t i = 0; i < N_next; ++i)
+            {
+                auto& dip = offspring[i];
+                dip.first = finalize_gamete(2 * i);
+                dip.second = finalize_gamete(2 * i + 1);
+                assert(pop.gametes[dip.first].n);
+                assert(pop.gametes[dip.second].n);
+                dip.label = label++;
+                update(rng, dip, pop, staging.parents[2 * i],
+                       staging.parents[2 * i + 1]);
+            }
+
+        bins.end_generation(pop.gametes);
+        bins.process_gametes(pop.gametes, pop.mutations.size(), pop.mcounts,
+                             2 * N_next);
+        // gamete_cleaner searches all of mcounts for fixations
+        if (bins.any_fixed())
+            {
+                KTfwd::fwdpp_internal::gamete_cleaner(
+                    pop.gametes, pop.mutations, pop.mcounts, 2 * N_next, mrp);
+            }
         pop.diploids.swap(offspring);
     }
 }
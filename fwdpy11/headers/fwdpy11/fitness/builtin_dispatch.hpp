@@ -0,0 +1,161 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_FITNESS_BUILTIN_DISPATCH_HPP__
+#define FWDPY11_FITNESS_BUILTIN_DISPATCH_HPP__
+
+#include <type_traits>
+#include <fwdpy11/types.hpp>
+#include "single_locus_fitness.hpp"
+#include "trait_values.hpp"
+
+namespace fwdpy11
+{
+    template <typename fitness_model_type> struct bound_fitness_model
+    /*!
+      A fwdpp fitness model bound to its scaling parameter.
+
+      This is what fwdpp_single_locus_fitness_wrapper::callback()
+      returns, but as a concrete type, so that calls may be inlined.
+    */
+    {
+        using fitness_model = fitness_model_type;
+        const fitness_model model;
+        const double scaling;
+        explicit bound_fitness_model(const double scaling_)
+            : model(fitness_model()), scaling(scaling_)
+        {
+        }
+        inline double
+        operator()(const diploid_t &dip, const gcont_t &gametes,
+                   const mcont_t &mutations) const
+        {
+            return model(dip, gametes, mutations, scaling);
+        }
+    };
+
+    template <typename fitness_fxn>
+    struct is_native_fitness : public std::false_type
+    /*!
+      True if calls to fitness_fxn never enter Python,
+      meaning that they may be made from several threads
+      without holding the GIL.
+    */
+    {
+    };
+
+    template <typename fitness_model>
+    struct is_native_fitness<bound_fitness_model<fitness_model>>
+        : public std::true_type
+    {
+    };
+
+    template <typename fitness_fxn>
+    struct neutral_fitness_is_one : public std::false_type
+    /*!
+      True if fitness_fxn returns exactly 1 for any diploid
+      without selected mutations, regardless of its neutral
+      mutations.
+    */
+    {
+    };
+
+    template <>
+    struct neutral_fitness_is_one<
+        bound_fitness_model<KTfwd::multiplicative_diploid>>
+        : public std::true_type
+    {
+    };
+
+    template <>
+    struct neutral_fitness_is_one<bound_fitness_model<KTfwd::additive_diploid>>
+        : public std::true_type
+    {
+    };
+
+    namespace detail
+    {
+        template <typename wrapper_t, typename visitor>
+        inline bool
+        visit_if(const single_locus_fitness &fitness, visitor &v)
+        {
+            auto p = dynamic_cast<const wrapper_t *>(&fitness);
+            if (p == nullptr)
+                return false;
+            v(bound_fitness_model<typename wrapper_t::fitness_model>(
+                p->scaling));
+            return true;
+        }
+    }
+
+    template <typename visitor>
+    inline void
+    dispatch_single_locus_fitness(const single_locus_fitness &fitness,
+                                  visitor &v)
+    /*!
+      Call v(f), where f is a callable with signature
+      double(const diploid_t &, const gcont_t &, const mcont_t &).
+
+      If \a fitness is one of the fitness or trait value types
+      built into fwdpy11, f is a bound_fitness_model, allowing
+      the code instantiated by v to be fully inlined.
+      Otherwise, f is the std::function returned by
+      fitness.callback().
+    */
+    {
+        if (detail::visit_if<single_locus_mult_wrapper>(fitness, v)
+            || detail::visit_if<single_locus_additive_wrapper>(fitness, v)
+            || detail::visit_if<single_locus_multiplicative_trait_wrapper>(
+                   fitness, v)
+            || detail::visit_if<single_locus_additive_trait_wrapper>(fitness,
+                                                                     v)
+            || detail::visit_if<gbr_trait_wrapper>(fitness, v))
+            {
+                return;
+            }
+        v(fitness.callback());
+    }
+
+    namespace detail
+    {
+        struct native_fitness_check
+        {
+            bool native;
+            template <typename fitness_fxn>
+            void
+            operator()(const fitness_fxn &)
+            {
+                native = is_native_fitness<fitness_fxn>::value;
+            }
+        };
+    }
+
+    inline bool
+    is_native_fitness_type(const single_locus_fitness &fitness)
+    /*!
+      True if \a fitness is one of the built-in types,
+      meaning that its callback never enters Python.
+    */
+    {
+        detail::native_fitness_check v{ false };
+        dispatch_single_locus_fitness(fitness, v);
+        return v.native;
+    }
+}
+
+#endif
@@ -0,0 +1,404 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_FITNESS_GVALUE_CACHE_HPP__
+#define FWDPY11_FITNESS_GVALUE_CACHE_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include <fwdpp/fitness_models.hpp>
+#include <fwdpy11/types.hpp>
+#include "builtin_dispatch.hpp"
+
+namespace fwdpy11
+{
+    struct additive_gvalue_policy
+    /*!
+      Per-gamete terms for additive models.
+      The term for a gamete is the sum of h*s over its
+      selected mutations.
+    */
+    {
+        static inline double
+        identity()
+        {
+            return 0.0;
+        }
+        template <typename mutation_t>
+        static inline double
+        het(const mutation_t &m, const double)
+        {
+            return m.h * m.s;
+        }
+        template <typename mutation_t>
+        static inline double
+        hom(const mutation_t &m, const double scaling)
+        {
+            return scaling * m.s;
+        }
+        static inline double
+        combine(const double a, const double b)
+        {
+            return a + b;
+        }
+        template <typename mutation_t>
+        static inline bool
+        make_homozygous(double &value, const mutation_t &m,
+                        const double scaling)
+        //! Replace two heterozygous terms with a homozygous one.
+        {
+            value += scaling * m.s - 2.0 * m.h * m.s;
+            return true;
+        }
+    };
+
+    struct multiplicative_gvalue_policy
+    /*!
+      Per-gamete terms for multiplicative models.
+      The term for a gamete is the product of 1+h*s over its
+      selected mutations.
+    */
+    {
+        static inline double
+        identity()
+        {
+            return 1.0;
+        }
+        template <typename mutation_t>
+        static inline double
+        het(const mutation_t &m, const double)
+        {
+            return 1.0 + m.h * m.s;
+        }
+        template <typename mutation_t>
+        static inline double
+        hom(const mutation_t &m, const double scaling)
+        {
+            return 1.0 + scaling * m.s;
+        }
+        static inline double
+        combine(const double a, const double b)
+        {
+            return a * b;
+        }
+        template <typename mutation_t>
+        static inline bool
+        make_homozygous(double &value, const mutation_t &m,
+                        const double scaling)
+        /*!
+          Replace two heterozygous terms with a homozygous one.
+          Returns false if the heterozygous term is zero,
+          in which case the caller must fall back to
+          calculating the value directly.
+        */
+        {
+            const double h = 1.0 + m.h * m.s;
+            if (h == 0.0)
+                return false;
+            value *= (1.0 + scaling * m.s) / (h * h);
+            return true;
+        }
+    };
+
+    struct additive_fitness_transform
+    {
+        inline double
+        operator()(const double x) const
+        {
+            return std::max(0.0, 1.0 + x);
+        }
+    };
+
+    struct multiplicative_fitness_transform
+    {
+        inline double
+        operator()(const double x) const
+        {
+            return std::max(0.0, x);
+        }
+    };
+
+    struct additive_trait_transform
+    {
+        inline double
+        operator()(const double x) const
+        {
+            return x;
+        }
+    };
+
+    struct multiplicative_trait_transform
+    {
+        inline double
+        operator()(const double x) const
+        {
+            return x - 1.0;
+        }
+    };
+
+    template <typename policy, typename transform, typename fitness_model>
+    class gamete_gvalue_cache
+    /*!
+      Cache of per-gamete partial genetic values for additive
+      and multiplicative models.
+
+      The value for a diploid is obtained by combining the two
+      gamete terms, and then correcting for mutations present on
+      both gametes.  The latter only requires comparing the
+      cached, sorted, mutation keys of the two gametes.
+
+      A gamete's terms are recalculated when:
+
+      1. It is new in the current generation.  offspring_created
+         must be called for every offspring, so that gametes
+         produced by recombination or mutation are detected.
+      2. Its number of selected mutations changed, which happens
+         when fixations are removed from gametes.
+
+      An instance is callable with the same signature as a
+      single_locus_fitness_fxn.  refresh() must be called first.
+
+      \note Results may differ from fwdpp's fitness models in the last
+      few bits, because terms are added/multiplied in a different order.
+      The cache also assumes that the effect sizes of segregating
+      mutations do not change during a simulation.
+    */
+    {
+      private:
+        const bound_fitness_model<fitness_model> direct;
+        const transform final_transform;
+        std::vector<double> het_terms, hom_terms;
+        std::vector<std::size_t> nselected;
+        std::vector<std::uint8_t> valid;
+        std::vector<std::vector<KTfwd::uint_t>> sorted_keys;
+
+        void
+        grow(const std::size_t n)
+        {
+            if (n > valid.size())
+                {
+                    het_terms.resize(n);
+                    hom_terms.resize(n);
+                    nselected.resize(n);
+                    valid.resize(n, 0);
+                    sorted_keys.resize(n);
+                }
+        }
+
+        void
+        compute(const std::size_t g, const gcont_t &gametes,
+                const mcont_t &mutations)
+        {
+            const auto &keys = gametes[g].smutations;
+            double het = policy::identity(), hom = policy::identity();
+            for (auto k : keys)
+                {
+                    het = policy::combine(
+                        het, policy::het(mutations[k], direct.scaling));
+                    hom = policy::combine(
+                        hom, policy::hom(mutations[k], direct.scaling));
+                }
+            het_terms[g] = het;
+            hom_terms[g] = hom;
+            nselected[g] = keys.size();
+            sorted_keys[g].assign(keys.begin(), keys.end());
+            std::sort(sorted_keys[g].begin(), sorted_keys[g].end());
+            valid[g] = 1;
+        }
+
+        inline void
+        check(const std::size_t g, const gcont_t &gametes,
+              const mcont_t &mutations)
+        {
+            if (!valid[g] || nselected[g] != gametes[g].smutations.size())
+                {
+                    compute(g, gametes, mutations);
+                }
+        }
+
+      public:
+        explicit gamete_gvalue_cache(const double scaling)
+            : direct(scaling), final_transform(transform()), het_terms{},
+              hom_terms{}, nselected{}, valid{}, sorted_keys{}
+        {
+        }
+
+        template <typename poptype>
+        inline void
+        offspring_created(const diploid_t &offspring, const poptype &pop,
+                          const std::size_t p1, const std::size_t p2)
+        /*!
+          An offspring gamete not found in its parent is new,
+          and its index may refer to a recycled gamete.
+        */
+        {
+            const auto &parent1 = pop.diploids[p1];
+            const auto &parent2 = pop.diploids[p2];
+            grow(std::max(offspring.first, offspring.second) + 1);
+            if (offspring.first != parent1.first
+                && offspring.first != parent1.second)
+                {
+                    valid[offspring.first] = 0;
+                }
+            if (offspring.second != parent2.first
+                && offspring.second != parent2.second)
+                {
+                    valid[offspring.second] = 0;
+                }
+        }
+
+        void
+        refresh(const singlepop_t &pop)
+        //! Update terms for all gametes in pop.diploids.
+        {
+            grow(pop.gametes.size());
+            for (const auto &dip : pop.diploids)
+                {
+                    check(dip.first, pop.gametes, pop.mutations);
+                    check(dip.second, pop.gametes, pop.mutations);
+                }
+        }
+
+        inline double
+        operator()(const diploid_t &dip, const gcont_t &gametes,
+                   const mcont_t &mutations) const
+        {
+            if (dip.first == dip.second)
+                {
+                    return final_transform(hom_terms[dip.first]);
+                }
+            double value
+                = policy::combine(het_terms[dip.first], het_terms[dip.second]);
+            const auto &a = sorted_keys[dip.first];
+            const auto &b = sorted_keys[dip.second];
+            if (!a.empty() && !b.empty())
+                {
+                    auto i = a.cbegin(), j = b.cbegin();
+                    while (i != a.cend() && j != b.cend())
+                        {
+                            if (*i < *j)
+                                ++i;
+                            else if (*j < *i)
+                                ++j;
+                            else
+                                {
+                                    if (!policy::make_homozygous(
+                                            value, mutations[*i],
+                                            direct.scaling))
+                                        {
+                                            return direct(dip, gametes,
+                                                          mutations);
+                                        }
+                                    ++i;
+                                    ++j;
+                                }
+                        }
+                }
+            return final_transform(value);
+        }
+    };
+
+    template <typename policy, typename transform, typename fitness_model>
+    struct is_native_fitness<
+        gamete_gvalue_cache<policy, transform, fitness_model>>
+        : public std::true_type
+    {
+    };
+
+    template <typename policy, typename fitness_model>
+    struct neutral_fitness_is_one<
+        gamete_gvalue_cache<policy, additive_fitness_transform, fitness_model>>
+        : public std::true_type
+    {
+    };
+
+    template <typename policy, typename fitness_model>
+    struct neutral_fitness_is_one<gamete_gvalue_cache<
+        policy, multiplicative_fitness_transform, fitness_model>>
+        : public std::true_type
+    {
+    };
+
+    struct no_gvalue_cache
+    //! Used in place of gamete_gvalue_cache when caching is not requested
+    {
+        template <typename poptype>
+        inline void
+        offspring_created(const diploid_t &, const poptype &,
+                          const std::size_t, const std::size_t)
+        {
+        }
+        template <typename poptype>
+        inline void
+        refresh(const poptype &)
+        {
+        }
+    };
+
+    template <typename fitness_fxn> struct gvalue_cache_traits
+    /*!
+      Maps a single-locus fitness callable to the corresponding
+      gamete_gvalue_cache.  Only defined for the built-in
+      additive and multiplicative models.
+    */
+    {
+        using supported = std::false_type;
+    };
+
+    template <>
+    struct gvalue_cache_traits<bound_fitness_model<KTfwd::additive_diploid>>
+    {
+        using supported = std::true_type;
+        using type = gamete_gvalue_cache<additive_gvalue_policy,
+                                         additive_fitness_transform,
+                                         KTfwd::additive_diploid>;
+    };
+
+    template <>
+    struct gvalue_cache_traits<
+        bound_fitness_model<KTfwd::multiplicative_diploid>>
+    {
+        using supported = std::true_type;
+        using type = gamete_gvalue_cache<multiplicative_gvalue_policy,
+                                         multiplicative_fitness_transform,
+                                         KTfwd::multiplicative_diploid>;
+    };
+
+    template <>
+    struct gvalue_cache_traits<bound_fitness_model<additive_diploid_trait_fxn>>
+    {
+        using supported = std::true_type;
+        using type = gamete_gvalue_cache<additive_gvalue_policy,
+                                         additive_trait_transform,
+                                         additive_diploid_trait_fxn>;
+    };
+
+    template <>
+    struct gvalue_cache_traits<
+        bound_fitness_model<multiplicative_diploid_trait_fxn>>
+    {
+        using supported = std::true_type;
+        using type = gamete_gvalue_cache<multiplicative_gvalue_policy,
+                                         multiplicative_trait_transform,
+                                         multiplicative_diploid_trait_fxn>;
+    };
+}
+
+#endif
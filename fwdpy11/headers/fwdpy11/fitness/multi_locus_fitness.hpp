@@ -25,6 +25,7 @@
 #include <vector>
 #include <pybind11/numpy.h>
 #include <fwdpy11/fitness/single_locus_fitness.hpp>
+#include <fwdpy11/fitness/builtin_dispatch.hpp>
 
 namespace fwdpy11
 {
@@ -41,6 +42,9 @@ namespace fwdpy11
         /// The genetic values are accessible to Python directly as a NumPy
         /// array:
         mutable pybind11::array_t<double> genetic_values_np;
+        /// True if all callbacks are built-in types, meaning
+        /// that fill() may be called without holding the GIL.
+        bool native;
 
         // Constructor takes vector of single region functions
         // and a function mapping individual-locus values -> overall value.
@@ -56,7 +60,8 @@ namespace fwdpy11
               genetic_values_np{ pybind11::buffer_info(
                   genetic_value_buffer.get(), sizeof(double),
                   pybind11::format_descriptor<double>::format(), 1,
-                  { fitness_functions_.size() }, { sizeof(double) }) }
+                  { fitness_functions_.size() }, { sizeof(double) }) },
+              native(true)
         {
             if (fitness_functions_.empty())
                 {
@@ -78,24 +83,41 @@ namespace fwdpy11
             for (auto&& ffi : fitness_functions)
                 {
                     callbacks.emplace_back(ffi->callback());
+                    native = native && is_native_fitness_type(*ffi);
                 }
         }
 
-        inline pybind11::array_t<double>
-        operator()(const fwdpy11::multilocus_diploid_t& dip,
-                   const fwdpy11::gcont_t& gametes,
-                   const fwdpy11::mcont_t& mutations) const
+        inline void
+        fill(const fwdpy11::multilocus_diploid_t& dip,
+             const fwdpy11::gcont_t& gametes,
+             const fwdpy11::mcont_t& mutations, double* out) const
+        /// Write the genetic value at each locus to out
         {
-            // use std::transform instead of loop b/c
-            // genetic_values_np.mutable_at does
-            // range-checking, which we do not need
-            std::transform(dip.cbegin(), dip.cend(), callbacks.cbegin(),
-                           genetic_values_np.mutable_data(),
+            std::transform(dip.cbegin(), dip.cend(), callbacks.cbegin(), out,
                            [&gametes, &mutations](
                                const fwdpy11::diploid_t& dip_locus_i,
                                const fwdpy11::single_locus_fitness_fxn& wf) {
                                return wf(dip_locus_i, gametes, mutations);
                            });
+        }
+
+        inline pybind11::array_t<double>
+        operator()(const fwdpy11::multilocus_diploid_t& dip,
+                   const fwdpy11::gcont_t& gametes,
+                   const fwdpy11::mcont_t& mutations) const
+        {
+            // use mutable_data instead of mutable_at b/c
+            // the latter does range-checking, which we do not need
+            fill(dip, gametes, mutations, genetic_values_np.mutable_data());
+            return genetic_values_np;
+        }
+
+        inline pybind11::array_t<double>
+        operator()(const double* values) const
+        /// Copy precomputed per-locus values into the NumPy array
+        {
+            std::copy(values, values + size(),
+                      genetic_values_np.mutable_data());
             return genetic_values_np;
         }
         inline std::size_t
@@ -0,0 +1,148 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_MULTILOCUS_AGGREGATORS_HPP__
+#define FWDPY11_MULTILOCUS_AGGREGATORS_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+namespace fwdpy11
+{
+    /*!
+      The built-in functions mapping per-locus genetic values
+      to an overall value.
+
+      Each type provides row(), which aggregates the nloci values
+      of one diploid, and a call operator taking a NumPy array,
+      which is used from Python.
+    */
+
+    struct aggregate_additive_fitness
+    {
+        static inline double
+        row(const double* g, const std::size_t nloci) noexcept
+        {
+            double sum = 0.0;
+            for (std::size_t i = 0; i < nloci; ++i)
+                sum += g[i];
+            return std::max(0., sum - double(nloci - 1));
+        }
+
+        inline double
+        operator()(const pybind11::array_t<double>& g) const noexcept
+        {
+            return row(g.data(), g.size());
+        }
+    };
+
+    struct aggregate_mult_fitness
+    {
+        static inline double
+        row(const double* g, const std::size_t nloci) noexcept
+        {
+            double prod = 1.0;
+            for (std::size_t i = 0; i < nloci; ++i)
+                prod *= g[i];
+            return std::max(0., prod);
+        }
+
+        inline double
+        operator()(const pybind11::array_t<double>& g) const noexcept
+        {
+            return row(g.data(), g.size());
+        }
+    };
+
+    struct aggregate_additive_trait
+    {
+        static inline double
+        row(const double* g, const std::size_t nloci) noexcept
+        {
+            double sum = 0.0;
+            for (std::size_t i = 0; i < nloci; ++i)
+                sum += g[i];
+            return sum;
+        }
+
+        inline double
+        operator()(const pybind11::array_t<double>& g) const noexcept
+        {
+            return row(g.data(), g.size());
+        }
+    };
+
+    struct aggregate_mult_trait
+    {
+        static inline double
+        row(const double* g, const std::size_t nloci) noexcept
+        {
+            double prod = 1.0;
+            for (std::size_t i = 0; i < nloci; ++i)
+                prod *= (1. + g[i]);
+            return prod - 1.0;
+        }
+
+        inline double
+        operator()(const pybind11::array_t<double>& g) const noexcept
+        {
+            return row(g.data(), g.size());
+        }
+    };
+
+    /*!
+      Aggregates an n by nloci row-major matrix of per-locus
+      values, writing n values to out.
+    */
+    using multilocus_aggregator_kernel
+        = void (*)(const double* values, const std::size_t n,
+                   const std::size_t nloci, double* out);
+
+    template <typename aggregator_t>
+    void
+    aggregate_rows(const double* values, const std::size_t n,
+                   const std::size_t nloci, double* out)
+    {
+        for (std::size_t i = 0; i < n; ++i, values += nloci)
+            {
+                out[i] = aggregator_t::row(values, nloci);
+            }
+    }
+
+    inline multilocus_aggregator_kernel
+    native_aggregator_kernel(pybind11::handle aggregator)
+    /*!
+      Return the kernel for one of the built-in aggregators,
+      or nullptr if \a aggregator is any other callable.
+    */
+    {
+        if (pybind11::isinstance<aggregate_additive_fitness>(aggregator))
+            return &aggregate_rows<aggregate_additive_fitness>;
+        if (pybind11::isinstance<aggregate_mult_fitness>(aggregator))
+            return &aggregate_rows<aggregate_mult_fitness>;
+        if (pybind11::isinstance<aggregate_additive_trait>(aggregator))
+            return &aggregate_rows<aggregate_additive_trait>;
+        if (pybind11::isinstance<aggregate_mult_trait>(aggregator))
+            return &aggregate_rows<aggregate_mult_trait>;
+        return nullptr;
+    }
+}
+
+#endif
@@ -0,0 +1,91 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_FITNESS_TRAIT_VALUES_HPP__
+#define FWDPY11_FITNESS_TRAIT_VALUES_HPP__
+
+#include <cmath>
+#include <numeric>
+#include <fwdpp/fitness_models.hpp>
+#include <fwdpy11/types.hpp>
+#include "single_locus_fitness.hpp"
+
+namespace fwdpy11
+{
+    struct additive_diploid_trait_fxn
+    {
+        const KTfwd::additive_diploid w;
+        additive_diploid_trait_fxn()
+            : w{ KTfwd::additive_diploid(KTfwd::atrait()) }
+        {
+        }
+        inline double
+        operator()(const diploid_t &dip, const gcont_t &gametes,
+                   const mcont_t &mutations, const double scaling) const
+        {
+            return w(dip, gametes, mutations, scaling);
+        }
+    };
+
+    struct multiplicative_diploid_trait_fxn
+    {
+        const KTfwd::multiplicative_diploid w;
+        multiplicative_diploid_trait_fxn()
+            : w{ KTfwd::multiplicative_diploid(KTfwd::mtrait()) }
+        {
+        }
+        inline double
+        operator()(const diploid_t &dip, const gcont_t &gametes,
+                   const mcont_t &mutations, const double scaling) const
+        {
+            return w(dip, gametes, mutations, scaling);
+        }
+    };
+
+    struct gbr_diploid_trait_fxn
+    {
+        inline double
+        operator()(const diploid_t &dip, const gcont_t &gametes,
+                   const mcont_t &mutations, const double) const
+        {
+            auto sum1 = std::accumulate(
+                gametes[dip.first].smutations.cbegin(),
+                gametes[dip.first].smutations.cend(), 0.,
+                [&mutations](const double s, const KTfwd::uint_t key) {
+                    return s + mutations[key].s;
+                });
+            auto sum2 = std::accumulate(
+                gametes[dip.second].smutations.cbegin(),
+                gametes[dip.second].smutations.cend(), 0.,
+                [&mutations](const double s, const KTfwd::uint_t key) {
+                    return s + mutations[key].s;
+                });
+            return std::sqrt(sum1 * sum2);
+        }
+    };
+
+    using single_locus_multiplicative_trait_wrapper
+        = fwdpp_single_locus_fitness_wrapper<
+            multiplicative_diploid_trait_fxn>;
+    using single_locus_additive_trait_wrapper
+        = fwdpp_single_locus_fitness_wrapper<additive_diploid_trait_fxn>;
+    using gbr_trait_wrapper
+        = fwdpp_single_locus_fitness_wrapper<gbr_diploid_trait_fxn>;
+}
+
+#endif
@@ -0,0 +1,247 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_PACKED_MATRIX_HPP__
+#define FWDPY11_PACKED_MATRIX_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <fwdpy11/types.hpp>
+
+namespace fwdpy11
+{
+    template <typename poptype, typename F>
+    void
+    visit_sampled_gametes(const poptype &pop,
+                          const std::vector<std::size_t> &individuals,
+                          const F &f)
+    /*!
+      Call f(gamete, chrom) for chromosomes 2i and 2i+1 of the
+      i-th sampled individual.
+    */
+    {
+        for (std::size_t i = 0; i < individuals.size(); ++i)
+            {
+                const auto &dip = pop.diploids[individuals[i]];
+                f(pop.gametes[dip.first], 2 * i);
+                f(pop.gametes[dip.second], 2 * i + 1);
+            }
+    }
+
+    template <typename F>
+    void
+    visit_sampled_gametes(const multilocus_t &pop,
+                          const std::vector<std::size_t> &individuals,
+                          const F &f)
+    /*!
+      For a multi-locus population, a chromosome is the gametes
+      of one parent at all loci.
+    */
+    {
+        for (std::size_t i = 0; i < individuals.size(); ++i)
+            {
+                for (const auto &locus : pop.diploids[individuals[i]])
+                    {
+                        f(pop.gametes[locus.first], 2 * i);
+                        f(pop.gametes[locus.second], 2 * i + 1);
+                    }
+            }
+    }
+
+    template <typename poptype>
+    void
+    validate_individuals(const poptype &pop,
+                         const std::vector<std::size_t> &individuals)
+    {
+        if (individuals.empty())
+            {
+                throw std::invalid_argument("empty list of individuals");
+            }
+        for (auto i : individuals)
+            {
+                if (i >= pop.diploids.size())
+                    {
+                        throw std::invalid_argument(
+                            "individual index out of range");
+                    }
+            }
+    }
+
+    struct packed_bit_matrix
+    /*!
+      A matrix of bits stored in 64-bit words.
+
+      If row_major is true, each row occupies words_per_line()
+      consecutive words, and cell (i, j) is bit j % 64 of word
+      i * words_per_line() + j / 64.  Otherwise, the same holds
+      with the roles of rows and columns exchanged.  Unused bits
+      at the end of each line are zero.
+    */
+    {
+        std::size_t nrow, ncol;
+        bool row_major;
+        std::vector<std::uint64_t> words;
+
+        packed_bit_matrix(const std::size_t nrow_, const std::size_t ncol_,
+                          const bool row_major_)
+            : nrow(nrow_), ncol(ncol_), row_major(row_major_),
+              words(nlines() * words_per_line(), 0)
+        {
+        }
+
+        inline std::size_t
+        nlines() const
+        //! The number of rows if row-major, else the number of columns
+        {
+            return row_major ? nrow : ncol;
+        }
+
+        inline std::size_t
+        words_per_line() const
+        {
+            return ((row_major ? ncol : nrow) + 63) / 64;
+        }
+
+        inline void
+        set(const std::size_t i, const std::size_t j)
+        {
+            const auto line = row_major ? i : j, bit = row_major ? j : i;
+            words[line * words_per_line() + bit / 64]
+                |= std::uint64_t(1) << (bit % 64);
+        }
+
+        inline bool
+        get(const std::size_t i, const std::size_t j) const
+        {
+            const auto line = row_major ? i : j, bit = row_major ? j : i;
+            return (words[line * words_per_line() + bit / 64] >> (bit % 64))
+                   & 1u;
+        }
+
+        void
+        unpack(std::int8_t *out) const
+        /*!
+          Write the matrix to \a out, one byte per cell,
+          in row-major order.
+        */
+        {
+            for (std::size_t i = 0; i < nrow; ++i)
+                {
+                    for (std::size_t j = 0; j < ncol; ++j)
+                        {
+                            out[i * ncol + j] = get(i, j);
+                        }
+                }
+        }
+    };
+
+    struct packed_haplotype_matrix
+    /*!
+      Bit-packed version of KTfwd::data_matrix encoded as a
+      haplotype matrix.  There are two rows per sampled diploid,
+      and one column per mutation key, in the order of the keys
+      used to create the matrix.
+    */
+    {
+        packed_bit_matrix neutral, selected;
+        std::vector<double> neutral_positions, selected_positions,
+            neutral_popfreq, selected_popfreq;
+
+        packed_haplotype_matrix(const std::size_t nrow,
+                                const std::size_t nneutral,
+                                const std::size_t nselected,
+                                const bool row_major)
+            : neutral(nrow, nneutral, row_major),
+              selected(nrow, nselected, row_major), neutral_positions{},
+              selected_positions{}, neutral_popfreq{}, selected_popfreq{}
+        {
+        }
+    };
+
+    template <typename poptype>
+    packed_haplotype_matrix
+    make_packed_haplotype_matrix(
+        const poptype &pop, const std::vector<std::size_t> &individuals,
+        const std::vector<std::pair<std::size_t, KTfwd::uint_t>>
+            &neutral_keys,
+        const std::vector<std::pair<std::size_t, KTfwd::uint_t>>
+            &selected_keys,
+        const bool row_major)
+    /*!
+      Equivalent to KTfwd::haplotype_matrix, but filling the bits
+      in a single pass over the sampled gametes, without creating
+      the matrix of bytes.
+    */
+    {
+        validate_individuals(pop, individuals);
+        packed_haplotype_matrix rv(2 * individuals.size(),
+                                   neutral_keys.size(), selected_keys.size(),
+                                   row_major);
+        const double twoN = 2.0 * static_cast<double>(pop.diploids.size());
+        const auto npos = std::numeric_limits<std::size_t>::max();
+        // Column of each mutation key in its partition
+        std::vector<std::size_t> neutral_column(pop.mutations.size(), npos),
+            selected_column(pop.mutations.size(), npos);
+        const auto index_keys
+            = [&pop, twoN](
+                  const std::vector<std::pair<std::size_t, KTfwd::uint_t>>
+                      &keys,
+                  std::vector<std::size_t> &column,
+                  std::vector<double> &positions,
+                  std::vector<double> &popfreq) {
+                  for (std::size_t i = 0; i < keys.size(); ++i)
+                      {
+                          const auto k = keys[i].first;
+                          if (k >= pop.mutations.size())
+                              {
+                                  throw std::invalid_argument(
+                                      "mutation key out of range");
+                              }
+                          column[k] = i;
+                          positions.push_back(pop.mutations[k].pos);
+                          popfreq.push_back(
+                              static_cast<double>(pop.mcounts[k]) / twoN);
+                      }
+              };
+        index_keys(neutral_keys, neutral_column, rv.neutral_positions,
+                   rv.neutral_popfreq);
+        index_keys(selected_keys, selected_column, rv.selected_positions,
+                   rv.selected_popfreq);
+        visit_sampled_gametes(
+            pop, individuals,
+            [&](const gamete_t &g, const std::size_t row) {
+                for (auto k : g.mutations)
+                    {
+                        if (neutral_column[k] != npos)
+                            rv.neutral.set(row, neutral_column[k]);
+                    }
+                for (auto k : g.smutations)
+                    {
+                        if (selected_column[k] != npos)
+                            rv.selected.set(row, selected_column[k]);
+                    }
+            });
+        return rv;
+    }
+}
+
+#endif
@@ -0,0 +1,378 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_RECORDERS_HPP__
+#define FWDPY11_RECORDERS_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <fwdpy11/types.hpp>
+
+namespace fwdpy11
+{
+    class native_recorder
+    /*!
+      Base class for temporal samplers implemented in C++.
+
+      The evolve functions call these directly, rather than via
+      Python, so there is no per-generation cost beyond the
+      calculation itself.  Data are only recorded when the
+      generation is a multiple of the sampling interval.
+    */
+    {
+      protected:
+        virtual void record(const singlepop_t &pop) = 0;
+        virtual void record(const multilocus_t &pop) = 0;
+
+      public:
+        const unsigned interval;
+
+        explicit native_recorder(const unsigned interval_)
+            : interval(interval_)
+        {
+            if (interval == 0)
+                {
+                    throw std::invalid_argument("interval must be > 0");
+                }
+        }
+
+        virtual ~native_recorder() {}
+
+        template <typename poptype>
+        inline void
+        operator()(const poptype &pop)
+        {
+            if (pop.generation % interval == 0)
+                {
+                    record(pop);
+                }
+        }
+    };
+
+    namespace detail
+    {
+        inline const diploid_t &
+        first_locus(const diploid_t &dip)
+        {
+            return dip;
+        }
+
+        inline const diploid_t &
+        first_locus(const multilocus_diploid_t &dip)
+        // For multi-locus diploids, g, e, and w are
+        // stored in the first locus.
+        {
+            return dip[0];
+        }
+    }
+
+    struct mean_fitness_record
+    {
+        std::uint32_t generation;
+        double wbar;
+    };
+
+    class mean_fitness_recorder : public native_recorder
+    //! Records mean fitness
+    {
+      private:
+        template <typename poptype>
+        void
+        record_details(const poptype &pop)
+        {
+            double sum = 0.0;
+            for (auto &&dip : pop.diploids)
+                {
+                    sum += detail::first_locus(dip).w;
+                }
+            data.push_back(mean_fitness_record{
+                pop.generation, sum / static_cast<double>(pop.N) });
+        }
+
+      protected:
+        void
+        record(const singlepop_t &pop) override
+        {
+            record_details(pop);
+        }
+        void
+        record(const multilocus_t &pop) override
+        {
+            record_details(pop);
+        }
+
+      public:
+        std::vector<mean_fitness_record> data;
+        mean_fitness_recorder(const unsigned interval,
+                              const std::size_t nsamples)
+            : native_recorder(interval), data{}
+        {
+            data.reserve(nsamples);
+        }
+    };
+
+    struct trait_record
+    {
+        std::uint32_t generation;
+        double mean, variance;
+    };
+
+    class trait_recorder : public native_recorder
+    /*!
+      Records the mean and variance of genetic values (the
+      "g" field of diploids).  The variance is the population
+      variance, i.e., the sum of squares is divided by N.
+    */
+    {
+      private:
+        template <typename poptype>
+        void
+        record_details(const poptype &pop)
+        {
+            // Welford's algorithm
+            double mean = 0.0, ss = 0.0;
+            std::size_t n = 0;
+            for (auto &&dip : pop.diploids)
+                {
+                    const double g = detail::first_locus(dip).g;
+                    ++n;
+                    const double delta = g - mean;
+                    mean += delta / static_cast<double>(n);
+                    ss += delta * (g - mean);
+                }
+            data.push_back(trait_record{
+                pop.generation, mean,
+                (n > 0) ? ss / static_cast<double>(n) : 0.0 });
+        }
+
+      protected:
+        void
+        record(const singlepop_t &pop) override
+        {
+            record_details(pop);
+        }
+        void
+        record(const multilocus_t &pop) override
+        {
+            record_details(pop);
+        }
+
+      public:
+        std::vector<trait_record> data;
+        trait_recorder(const unsigned interval, const std::size_t nsamples)
+            : native_recorder(interval), data{}
+        {
+            data.reserve(nsamples);
+        }
+    };
+
+    struct segsites_record
+    {
+        std::uint32_t generation, neutral, selected;
+    };
+
+    class segsites_recorder : public native_recorder
+    /*!
+      Records the number of neutral and selected mutations
+      present in more than zero and fewer than 2N copies.
+    */
+    {
+      private:
+        template <typename poptype>
+        void
+        record_details(const poptype &pop)
+        {
+            const auto twoN = 2 * pop.N;
+            segsites_record r{ pop.generation, 0, 0 };
+            for (std::size_t i = 0; i < pop.mcounts.size(); ++i)
+                {
+                    const auto n = pop.mcounts[i];
+                    if (n > 0 && n < twoN)
+                        {
+                            if (pop.mutations[i].neutral)
+                                ++r.neutral;
+                            else
+                                ++r.selected;
+                        }
+                }
+            data.push_back(r);
+        }
+
+      protected:
+        void
+        record(const singlepop_t &pop) override
+        {
+            record_details(pop);
+        }
+        void
+        record(const multilocus_t &pop) override
+        {
+            record_details(pop);
+        }
+
+      public:
+        std::vector<segsites_record> data;
+        segsites_recorder(const unsigned interval, const std::size_t nsamples)
+            : native_recorder(interval), data{}
+        {
+            data.reserve(nsamples);
+        }
+    };
+
+    class sfs_recorder : public native_recorder
+    /*!
+      Records the site frequency spectrum of segregating mutations.
+
+      Each sample is a row of nbins counts.  A mutation present in
+      n of 2N copies is placed in bin (n-1)*nbins/(2N-1), so that,
+      when nbins = 2N-1, element i is the number of mutations
+      present in i+1 copies.  Bins are used because N may change
+      during a simulation.
+    */
+    {
+      private:
+        template <typename poptype>
+        void
+        record_details(const poptype &pop)
+        {
+            const std::uint64_t twoN = 2 * pop.N;
+            const auto offset = counts.size();
+            counts.resize(offset + nbins, 0);
+            for (std::size_t i = 0; i < pop.mcounts.size(); ++i)
+                {
+                    const std::uint64_t n = pop.mcounts[i];
+                    if (n > 0 && n < twoN)
+                        {
+                            const auto bin = ((n - 1) * nbins) / (twoN - 1);
+                            ++counts[offset + bin];
+                        }
+                }
+            generations.push_back(pop.generation);
+        }
+
+      protected:
+        void
+        record(const singlepop_t &pop) override
+        {
+            record_details(pop);
+        }
+        void
+        record(const multilocus_t &pop) override
+        {
+            record_details(pop);
+        }
+
+      public:
+        const std::size_t nbins;
+        //! The generation of each sample
+        std::vector<std::uint32_t> generations;
+        //! Row-major matrix of counts, one row per sample
+        std::vector<std::uint32_t> counts;
+        sfs_recorder(const unsigned interval, const std::size_t nbins_,
+                     const std::size_t nsamples)
+            : native_recorder(interval), nbins(nbins_), generations{},
+              counts{}
+        {
+            if (nbins == 0)
+                {
+                    throw std::invalid_argument("nbins must be > 0");
+                }
+            generations.reserve(nsamples);
+            counts.reserve(nsamples * nbins);
+        }
+    };
+
+    struct fixation_record
+    {
+        std::uint32_t generation, origin;
+        double pos, s, h;
+        std::int8_t neutral;
+    };
+
+    class fixation_recorder : public native_recorder
+    /*!
+      Records fixations that happened since the previous sample.
+      The generation field of a record is the fixation time.
+    */
+    {
+      private:
+        //! Generation of the previous sample
+        std::uint32_t last;
+        bool sampled;
+        //! Indexes of the fixations to record
+        std::vector<std::size_t> index;
+
+        template <typename poptype>
+        void
+        record_details(const poptype &pop)
+        {
+            // pop.fixations is sorted by position, so new fixations
+            // are found by their fixation times and not by index.
+            if (sampled && pop.generation < last)
+                {
+                    // Not the population we saw last time
+                    sampled = false;
+                }
+            index.clear();
+            for (std::size_t i = 0; i < pop.fixations.size(); ++i)
+                {
+                    if (!sampled || pop.fixation_times[i] > last)
+                        index.push_back(i);
+                }
+            std::stable_sort(index.begin(), index.end(),
+                             [&pop](const std::size_t a, const std::size_t b) {
+                                 return pop.fixation_times[a]
+                                        < pop.fixation_times[b];
+                             });
+            for (auto i : index)
+                {
+                    const auto &m = pop.fixations[i];
+                    data.push_back(fixation_record{
+                        pop.fixation_times[i], m.g, m.pos, m.s, m.h,
+                        static_cast<std::int8_t>(m.neutral) });
+                }
+            last = pop.generation;
+            sampled = true;
+        }
+
+      protected:
+        void
+        record(const singlepop_t &pop) override
+        {
+            record_details(pop);
+        }
+        void
+        record(const multilocus_t &pop) override
+        {
+            record_details(pop);
+        }
+
+      public:
+        std::vector<fixation_record> data;
+        explicit fixation_recorder(const unsigned interval)
+            : native_recorder(interval), last(0), sampled(false), index{},
+              data{}
+        {
+        }
+    };
+}
+
+#endif
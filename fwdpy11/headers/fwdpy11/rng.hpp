@@ -19,17 +19,317 @@
 #ifndef FWDPY11_RNG_HPP__
 #define FWDPY11_RNG_HPP__
 
-#include <fwdpp/sugar/GSLrng_t.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
 
 namespace fwdpy11
 {
+    namespace detail
+    {
+        struct xoshiro256_state
+        {
+            std::uint64_t s[4];
+        };
+
+        inline std::uint64_t
+        rotl(const std::uint64_t x, const int k)
+        {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        inline std::uint64_t
+        xoshiro256_next(xoshiro256_state *state)
+        //! xoshiro256** by Blackman and Vigna (http://xoshiro.di.unimi.it)
+        {
+            auto &s = state->s;
+            const std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+            const std::uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+
+        inline double
+        xoshiro256_uniform(xoshiro256_state *state)
+        //! Uniform deviate on [0,1) with 53 random bits
+        {
+            return static_cast<double>(xoshiro256_next(state) >> 11)
+                   * (1.0 / 9007199254740992.0);
+        }
+
+        inline void
+        xoshiro256_set(void *vstate, unsigned long seed)
+        /*!
+          The state is filled using splitmix64, as recommended
+          by the authors of xoshiro.
+        */
+        {
+            auto state = static_cast<xoshiro256_state *>(vstate);
+            std::uint64_t x = seed;
+            for (auto &s : state->s)
+                {
+                    std::uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                    s = z ^ (z >> 31);
+                }
+        }
+
+        inline unsigned long
+        xoshiro256_get(void *vstate)
+        //! The upper 32 bits, so that max is the same on all platforms.
+        {
+            return static_cast<unsigned long>(
+                xoshiro256_next(static_cast<xoshiro256_state *>(vstate))
+                >> 32);
+        }
+
+        inline double
+        xoshiro256_get_double(void *vstate)
+        {
+            return xoshiro256_uniform(static_cast<xoshiro256_state *>(vstate));
+        }
+
+        inline void
+        xoshiro256_jump(xoshiro256_state *state)
+        //! Equivalent to 2^128 calls to xoshiro256_next
+        {
+            static const std::uint64_t jump[]
+                = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+            std::uint64_t s[4] = { 0, 0, 0, 0 };
+            for (auto j : jump)
+                {
+                    for (int b = 0; b < 64; ++b)
+                        {
+                            if (j & (std::uint64_t(1) << b))
+                                {
+                                    for (int i = 0; i < 4; ++i)
+                                        s[i] ^= state->s[i];
+                                }
+                            xoshiro256_next(state);
+                        }
+                }
+            std::memcpy(state->s, s, sizeof(s));
+        }
+    }
+
+    inline const gsl_rng_type *
+    gsl_rng_xoshiro256()
+    /*!
+      A gsl_rng_type for the xoshiro256** generator, so that it may be
+      used with any GSL distribution.
+
+      Each extension module has its own copy of this object, so
+      generators must be identified via is_xoshiro256 rather than by
+      comparing pointers.
+    */
+    {
+        static const gsl_rng_type type
+            = { "xoshiro256**", 0xffffffffUL, 0,
+                sizeof(detail::xoshiro256_state), &detail::xoshiro256_set,
+                &detail::xoshiro256_get, &detail::xoshiro256_get_double };
+        return &type;
+    }
+
+    inline bool
+    is_xoshiro256(const gsl_rng *r)
+    {
+        return std::strcmp(r->type->name, gsl_rng_xoshiro256()->name) == 0;
+    }
+
+    class GSLrng_t
     /*!
       Random number generator.
 
-      This is a std::unique_ptr wrapper to a gsl_rng * initialized
-      as a Mersenne twister type (gsl_rng_mt19937).
+      This is a std::unique_ptr wrapper to a gsl_rng *.  By default,
+      it is initialized as a Mersenne twister type (gsl_rng_mt19937).
+    */
+    {
+      private:
+        struct gsl_rng_deleter
+        {
+            void
+            operator()(gsl_rng *r) const noexcept
+            {
+                gsl_rng_free(r);
+            }
+        };
+        using gsl_rng_ptr_t = std::unique_ptr<gsl_rng, gsl_rng_deleter>;
+        gsl_rng_ptr_t r;
+
+        static gsl_rng_ptr_t
+        make(const gsl_rng_type *T, const unsigned long seed)
+        {
+            gsl_rng_ptr_t rv(gsl_rng_alloc(T));
+            if (rv == nullptr)
+                {
+                    throw std::runtime_error(
+                        "could not allocate random number generator");
+                }
+            gsl_rng_set(rv.get(), seed);
+            return rv;
+        }
+
+      public:
+        explicit GSLrng_t(const unsigned seed)
+            : r(make(gsl_rng_mt19937, seed))
+        {
+        }
+
+        GSLrng_t(const gsl_rng_type *T, const unsigned long seed)
+            : r(make(T, seed))
+        {
+        }
+
+        GSLrng_t(const GSLrng_t &rng) : r(gsl_rng_clone(rng.get())) {}
+
+        GSLrng_t &
+        operator=(const GSLrng_t &rng)
+        {
+            r.reset(gsl_rng_clone(rng.get()));
+            return *this;
+        }
+
+        GSLrng_t(GSLrng_t &&) = default;
+        GSLrng_t &operator=(GSLrng_t &&) = default;
+
+        inline const gsl_rng *
+        get() const
+        {
+            return r.get();
+        }
+    };
+
+    class xoshiro256_rng : public GSLrng_t
+    /*!
+      A GSLrng_t using xoshiro256** rather than a Mersenne twister.
+
+      It is cheaper per draw and its stream may be split into
+      independent substreams of length 2^128 via jump().
+    */
+    {
+      public:
+        explicit xoshiro256_rng(const unsigned long seed)
+            : GSLrng_t(gsl_rng_xoshiro256(), seed)
+        {
+        }
+
+        void
+        jump()
+        //! Advance the state by 2^128 draws.
+        {
+            detail::xoshiro256_jump(
+                static_cast<detail::xoshiro256_state *>(get()->state));
+        }
+
+        std::vector<xoshiro256_rng>
+        substreams(const unsigned n)
+        /*!
+          Return \a n non-overlapping generators, e.g. one per
+          replicate simulation.  This object is advanced past
+          all of them.
+        */
+        {
+            std::vector<xoshiro256_rng> rv;
+            rv.reserve(n);
+            for (unsigned i = 0; i < n; ++i)
+                {
+                    jump();
+                    rv.push_back(*this);
+                }
+            jump();
+            return rv;
+        }
+    };
+
+    inline std::vector<GSLrng_t>
+    make_thread_rngs(const GSLrng_t &rng, const unsigned nthreads)
+    /*!
+      Return one independent random number stream per thread.
+
+      For xoshiro256**, the streams are obtained by jumping ahead
+      from the state of \a rng, which is then advanced past them.
+      Otherwise, each stream is seeded from successive draws from
+      \a rng.  Either way, the streams are a deterministic function
+      of the state of \a rng.
+    */
+    {
+        std::vector<GSLrng_t> rv;
+        rv.reserve(nthreads);
+        if (is_xoshiro256(rng.get()))
+            {
+                // As with gsl_rng_get, the state is modified via
+                // a const gsl_rng *.
+                auto state = static_cast<detail::xoshiro256_state *>(
+                    rng.get()->state);
+                for (unsigned i = 0; i < nthreads; ++i)
+                    {
+                        detail::xoshiro256_jump(state);
+                        rv.push_back(rng);
+                    }
+                detail::xoshiro256_jump(state);
+                return rv;
+            }
+        for (unsigned i = 0; i < nthreads; ++i)
+            {
+                rv.emplace_back(
+                    static_cast<unsigned>(gsl_rng_get(rng.get())));
+            }
+        return rv;
+    }
+
+    inline void
+    fill_uniform(const GSLrng_t &rng, double *out, const std::size_t n)
+    /*!
+      Fill \a out with \a n uniform deviates on [0,1).
+
+      For xoshiro256**, the generator is called directly,
+      bypassing GSL's dispatch via function pointers.
+      The values are the same as n calls to gsl_rng_uniform.
+    */
+    {
+        const gsl_rng *r = rng.get();
+        if (is_xoshiro256(r))
+            {
+                auto state
+                    = static_cast<detail::xoshiro256_state *>(r->state);
+                for (std::size_t i = 0; i < n; ++i)
+                    {
+                        out[i] = detail::xoshiro256_uniform(state);
+                    }
+                return;
+            }
+        for (std::size_t i = 0; i < n; ++i)
+            {
+                out[i] = gsl_rng_uniform(r);
+            }
+    }
+
+    inline void
+    fill_gaussian(const GSLrng_t &rng, const double sd, double *out,
+                  const std::size_t n)
+    /*!
+      Fill \a out with \a n Gaussian deviates with mean zero and
+      standard deviation \a sd.  The values are the same as n calls
+      to gsl_ran_gaussian_ziggurat.
     */
-    using GSLrng_t = KTfwd::GSLrng_t<KTfwd::GSL_RNG_MT19937>;
+    {
+        const gsl_rng *r = rng.get();
+        for (std::size_t i = 0; i < n; ++i)
+            {
+                out[i] = gsl_ran_gaussian_ziggurat(r, sd);
+            }
+    }
 }
 
 #endif
@@ -0,0 +1,234 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_RULES_ALIAS_SAMPLER_HPP__
+#define FWDPY11_RULES_ALIAS_SAMPLER_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <gsl/gsl_rng.h>
+#include <fwdpy11/thread_pool.hpp>
+
+namespace fwdpy11
+{
+    class alias_sampler
+    /*!
+      Walker's alias method for sampling from a discrete
+      distribution, using Vose's construction.
+
+      This replaces gsl_ran_discrete_preproc/gsl_ran_discrete
+      for choosing parents.  All storage is re-used when the
+      table is rebuilt, so that there is no allocation once the
+      population size stops growing.
+
+      The weights are summed in fixed-size chunks, and the chunk
+      sums are added in order.  Thus, the table is identical
+      whether or not it is built using a thread_pool.
+    */
+    {
+      private:
+        std::vector<double> prob;
+        std::vector<std::uint32_t> alias;
+        std::vector<std::uint32_t> small, large;
+        std::vector<double> chunk_sums;
+        std::vector<unsigned char> chunk_errors;
+
+        static constexpr std::size_t chunk_size = 4096;
+
+        void
+        sum_chunk(const double *weights, const std::size_t n,
+                  const std::size_t chunk)
+        {
+            const std::size_t beg = chunk * chunk_size;
+            const std::size_t end = std::min(n, beg + chunk_size);
+            double sum = 0.0;
+            unsigned char error = 0;
+            for (std::size_t i = beg; i < end; ++i)
+                {
+                    if (!(weights[i] >= 0.0) || !std::isfinite(weights[i]))
+                        {
+                            error = 1;
+                        }
+                    sum += weights[i];
+                }
+            chunk_sums[chunk] = sum;
+            chunk_errors[chunk] = error;
+        }
+
+        void
+        scale(const double *weights, const std::size_t beg,
+              const std::size_t end, const double multiplier)
+        {
+            for (std::size_t i = beg; i < end; ++i)
+                {
+                    prob[i] = weights[i] * multiplier;
+                }
+        }
+
+      public:
+        alias_sampler()
+            : prob{}, alias{}, small{}, large{}, chunk_sums{}, chunk_errors{}
+        {
+        }
+
+        inline std::size_t
+        size() const
+        {
+            return prob.size();
+        }
+
+        inline bool
+        empty() const
+        {
+            return prob.empty();
+        }
+
+        void
+        assign(const double *weights, const std::size_t n,
+               thread_pool *pool = nullptr)
+        /*!
+          Build the table from \a n non-negative weights.
+          If \a pool is not nullptr, the summation and scaling
+          of the weights are done in parallel.
+
+          \throw std::runtime_error if \a n is zero, any weight is
+          negative or not finite, or the weights sum to zero.
+        */
+        {
+            if (n == 0)
+                {
+                    throw std::runtime_error(
+                        "cannot sample from an empty set of weights");
+                }
+            if (n > std::numeric_limits<std::uint32_t>::max())
+                {
+                    throw std::runtime_error("too many weights");
+                }
+            const std::size_t nchunks = (n + chunk_size - 1) / chunk_size;
+            chunk_sums.resize(nchunks);
+            chunk_errors.resize(nchunks);
+            prob.resize(n);
+            alias.resize(n);
+
+            if (pool != nullptr && pool->size() > 1 && nchunks > 1)
+                {
+                    pool->run_blocks(nchunks, [this, weights, n](
+                                                  const unsigned,
+                                                  const std::size_t beg,
+                                                  const std::size_t end) {
+                        for (std::size_t c = beg; c < end; ++c)
+                            {
+                                this->sum_chunk(weights, n, c);
+                            }
+                    });
+                }
+            else
+                {
+                    for (std::size_t c = 0; c < nchunks; ++c)
+                        {
+                            sum_chunk(weights, n, c);
+                        }
+                }
+            double total = 0.0;
+            for (std::size_t c = 0; c < nchunks; ++c)
+                {
+                    if (chunk_errors[c])
+                        {
+                            throw std::runtime_error(
+                                "weights must be non-negative and finite");
+                        }
+                    total += chunk_sums[c];
+                }
+            if (!(total > 0.0) || !std::isfinite(total))
+                {
+                    throw std::runtime_error(
+                        "sum of weights must be positive and finite");
+                }
+
+            const double multiplier = double(n) / total;
+            if (pool != nullptr && pool->size() > 1 && nchunks > 1)
+                {
+                    pool->run_blocks(n, [this, weights, multiplier](
+                                            const unsigned,
+                                            const std::size_t beg,
+                                            const std::size_t end) {
+                        this->scale(weights, beg, end, multiplier);
+                    });
+                }
+            else
+                {
+                    scale(weights, 0, n, multiplier);
+                }
+
+            // Vose's method
+            small.clear();
+            large.clear();
+            for (std::uint32_t i = 0; i < n; ++i)
+                {
+                    if (prob[i] < 1.0)
+                        small.push_back(i);
+                    else
+                        large.push_back(i);
+                }
+            while (!small.empty() && !large.empty())
+                {
+                    const auto l = small.back();
+                    small.pop_back();
+                    const auto g = large.back();
+                    alias[l] = g;
+                    prob[g] = (prob[g] + prob[l]) - 1.0;
+                    if (prob[g] < 1.0)
+                        {
+                            large.pop_back();
+                            small.push_back(g);
+                        }
+                }
+            // Anything left over is due to rounding error
+            for (auto i : large)
+                {
+                    prob[i] = 1.0;
+                    alias[i] = i;
+                }
+            for (auto i : small)
+                {
+                    prob[i] = 1.0;
+                    alias[i] = i;
+                }
+        }
+
+        inline std::size_t
+        operator()(const gsl_rng *r) const
+        /*!
+          Return an index in [0, size()).
+        */
+        {
+            const double u = gsl_rng_uniform(r) * double(prob.size());
+            std::size_t i = static_cast<std::size_t>(u);
+            // Guard against rounding when u is just below size()
+            if (i >= prob.size())
+                i = prob.size() - 1;
+            return (u - double(i) < prob[i]) ? i : alias[i];
+        }
+    };
+}
+
+#endif
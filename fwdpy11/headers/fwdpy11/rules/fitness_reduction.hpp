@@ -0,0 +1,79 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_RULES_FITNESS_REDUCTION_HPP__
+#define FWDPY11_RULES_FITNESS_REDUCTION_HPP__
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+#include <pybind11/pybind11.h>
+#include <fwdpy11/thread_pool.hpp>
+
+namespace fwdpy11
+{
+    template <typename F>
+    inline double
+    sum_fitnesses(const std::size_t n, thread_pool *pool,
+                  std::vector<double> &chunk_sums, const F &f)
+    /*!
+      Call f(i) for each i in [0, n) and return the sum of the
+      values returned.  f(i) is expected to calculate and store
+      the fitness of the i-th diploid.
+
+      [0, n) is processed in fixed-size chunks.  The chunk sums are
+      added in order, so that the result does not depend on whether
+      \a pool is used, or on its size.
+
+      If \a pool is not nullptr, chunks are processed in parallel
+      and the GIL is released.  Thus, \a pool must be nullptr
+      whenever f may call into Python.
+    */
+    {
+        const std::size_t chunk_size = 1024;
+        const std::size_t nchunks = (n + chunk_size - 1) / chunk_size;
+        chunk_sums.resize(nchunks);
+        const auto process = [n, chunk_size, &chunk_sums, &f](
+            const unsigned, const std::size_t beg, const std::size_t end) {
+            for (std::size_t c = beg; c < end; ++c)
+                {
+                    const std::size_t last
+                        = std::min(n, (c + 1) * chunk_size);
+                    double sum = 0.0;
+                    for (std::size_t i = c * chunk_size; i < last; ++i)
+                        {
+                            sum += f(i);
+                        }
+                    chunk_sums[c] = sum;
+                }
+        };
+        if (pool != nullptr && pool->size() > 1 && nchunks > 1)
+            {
+                pybind11::gil_scoped_release release;
+                pool->run_blocks(nchunks, process);
+            }
+        else
+            {
+                process(0u, 0, nchunks);
+            }
+        return std::accumulate(chunk_sums.cbegin(), chunk_sums.cend(), 0.0);
+    }
+}
+
+#endif
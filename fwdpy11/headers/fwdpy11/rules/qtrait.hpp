@@ -2,7 +2,10 @@
 #define FWDPY11_RULES_QTRAIT_HPP__
 
 #include "fwdpy11/rules/rules_base.hpp"
+#include "fwdpy11/rules/fitness_reduction.hpp"
 #include <fwdpy11/evolve/qtrait_api.hpp>
+#include <fwdpy11/fitness/builtin_dispatch.hpp>
+#include <fwdpy11/fitness/multilocus_aggregators.hpp>
 #include <pybind11/numpy.h>
 #include <functional>
 #include <cmath>
@@ -12,7 +15,13 @@ namespace fwdpy11
 {
     namespace qtrait
     {
-        struct qtrait_model_rules : public fwdpy11::single_region_rules_base
+        struct qtrait_model_rules final
+            : public fwdpy11::single_region_rules_base
+        /*!
+          \note This type is final so that calls to its member
+          functions via a qtrait_model_rules & are not dispatched
+          virtually.
+        */
         {
             using base_t = fwdpy11::single_region_rules_base;
             trait_to_fitness_function trait_to_fitness;
@@ -28,35 +37,77 @@ namespace fwdpy11
 
             qtrait_model_rules(const qtrait_model_rules &rhs) : base_t(rhs) {}
 
-            virtual double
-            w(singlepop_t &pop, const single_locus_fitness_fxn &ff)
+            template <typename fitness_fxn>
+            inline double
+            w(singlepop_t &pop, const fitness_fxn &ff)
+            /*!
+              Calculate trait values and fitness for each diploid.
+              This template is called directly when ff is one of the
+              built-in types, allowing ff to be inlined.
+
+              If pool is set and ff is one of the built-in types,
+              trait values are calculated in parallel.  Fitnesses
+              are also calculated in parallel if trait_to_fitness
+              is a C++ function.  Otherwise, it may be a Python
+              callable, and is called from this thread.
+            */
             {
                 auto N_curr = pop.diploids.size();
                 if (fitnesses.size() < N_curr)
                     fitnesses.resize(N_curr);
-                wbar = 0.;
-                for (size_t i = 0; i < N_curr; ++i)
+                thread_pool *gvalue_pool
+                    = is_native_fitness<fitness_fxn>::value ? pool : nullptr;
+                const auto to_fitness = [this, &pop](const std::size_t i) {
+                    pop.diploids[i].w = trait_to_fitness(pop.diploids[i].g,
+                                                         pop.diploids[i].e);
+                    assert(std::isfinite(pop.diploids[i].w));
+                    fitnesses[i] = pop.diploids[i].w;
+                    return fitnesses[i];
+                };
+                if (gvalue_pool == nullptr
+                    || native_trait_to_fitness(trait_to_fitness))
+                    {
+                        wbar = sum_fitnesses(
+                            N_curr, gvalue_pool, chunk_sums,
+                            [&pop, &ff, &to_fitness](const std::size_t i) {
+                                pop.diploids[i].g = ff(pop.diploids[i],
+                                                       pop.gametes,
+                                                       pop.mutations);
+                                return to_fitness(i);
+                            });
+                    }
+                else
                     {
-                        pop.diploids[i].g
-                            = ff(pop.diploids[i], pop.gametes, pop.mutations);
-                        pop.diploids[i].w = trait_to_fitness(
-                            pop.diploids[i].g, pop.diploids[i].e);
-                        assert(std::isfinite(pop.diploids[i].w));
-                        fitnesses[i] = pop.diploids[i].w;
-                        wbar += pop.diploids[i].w;
+                        // Trait values in parallel, then fitnesses on
+                        // this thread.  The return values of the first
+                        // pass are not used.
+                        sum_fitnesses(N_curr, gvalue_pool, chunk_sums,
+                                      [&pop, &ff](const std::size_t i) {
+                                          pop.diploids[i].g = ff(
+                                              pop.diploids[i], pop.gametes,
+                                              pop.mutations);
+                                          return 0.0;
+                                      });
+                        wbar = sum_fitnesses(N_curr, nullptr, chunk_sums,
+                                             to_fitness);
                     }
                 wbar /= double(N_curr);
-                lookup = KTfwd::fwdpp_internal::gsl_ran_discrete_t_ptr(
-                    gsl_ran_discrete_preproc(N_curr, &fitnesses[0]));
+                lookup.assign(fitnesses.data(), N_curr, pool);
                 return wbar;
             }
 
+            double
+            w(singlepop_t &pop, const single_locus_fitness_fxn &ff) override
+            {
+                return this->w<single_locus_fitness_fxn>(pop, ff);
+            }
+
             //! \brief Update some property of the offspring based on
             //! properties of the parents
-            virtual void
+            void
             update(const GSLrng_t &rng, diploid_t &offspring,
                    const singlepop_t &pop, const std::size_t p1,
-                   const std::size_t p2) noexcept
+                   const std::size_t p2) noexcept override
             {
                 offspring.e
                     = noise_function(pop.diploids[p1], pop.diploids[p2]);
@@ -73,63 +124,126 @@ namespace fwdpy11
             multilocus_noise_function noise_function;
             mutable std::vector<double> fitnesses;
 
-            mutable KTfwd::fwdpp_internal::gsl_ran_discrete_t_ptr lookup;
+            mutable alias_sampler lookup;
+            //! If not nullptr, used to calculate per-locus genetic values
+            //! in parallel.  Not owned by this object.
+            thread_pool *pool;
+            //! If not nullptr, used in place of aggregator.
+            //! See native_aggregator_kernel.
+            multilocus_aggregator_kernel aggregator_kernel;
+            //! Work space for w()
+            mutable std::vector<double> chunk_sums, locus_gvalues,
+                aggregated;
             //! \brief Constructor
             qtrait_mloc_rules(multilocus_aggregator_function ag,
                               trait_to_fitness_function t2f,
                               multilocus_noise_function nf)
                 : wbar(0.), aggregator{ std::move(ag) },
                   trait_to_fitness{ std::move(t2f) },
-                  noise_function{ std::move(nf) }, fitnesses{}
+                  noise_function{ std::move(nf) }, fitnesses{}, lookup{},
+                  pool(nullptr), aggregator_kernel(nullptr), chunk_sums{},
+                  locus_gvalues{}, aggregated{}
             {
             }
 
             qtrait_mloc_rules(qtrait_mloc_rules &&) = default;
 
-            qtrait_mloc_rules(const qtrait_mloc_rules &rhs)
-            {
-                if (!fitnesses.empty())
-                    lookup = KTfwd::fwdpp_internal::gsl_ran_discrete_t_ptr(
-                        gsl_ran_discrete_preproc(fitnesses.size(),
-                                                 &fitnesses[0]));
-            }
+            qtrait_mloc_rules(const qtrait_mloc_rules &rhs) = default;
 
             //! \brief The "fitness manager"
             double
             w(multilocus_t &pop, const multilocus_genetic_value &gvalue) const
+            /*!
+              If pool is set and all per-locus genetic value
+              functions are built-in types, the per-locus values
+              are calculated in parallel.  The aggregator and
+              trait_to_fitness may be Python callables, and are
+              called from this thread.
+
+              If aggregator_kernel is set, the per-locus values of
+              all diploids are stored in an N by nloci matrix,
+              which is aggregated in a single call, and no NumPy
+              arrays are used.
+            */
             {
+                if (aggregator_kernel != nullptr)
+                    {
+                        return w_native_aggregator(pop, gvalue);
+                    }
                 unsigned N_curr = pop.diploids.size();
                 if (fitnesses.size() < N_curr)
                     fitnesses.resize(N_curr);
-                wbar = 0.;
-
-                for (unsigned i = 0; i < N_curr; ++i)
+                const std::size_t nloci = gvalue.size();
+                const bool parallel = (pool != nullptr && gvalue.native);
+                if (parallel)
                     {
-                        pop.diploids[i][0].g = aggregator(gvalue(
-                            pop.diploids[i], pop.gametes, pop.mutations));
+                        locus_gvalues.resize(N_curr * nloci);
+                        sum_fitnesses(
+                            N_curr, pool, chunk_sums,
+                            [this, &pop, &gvalue,
+                             nloci](const std::size_t i) {
+                                gvalue.fill(pop.diploids[i], pop.gametes,
+                                            pop.mutations,
+                                            locus_gvalues.data() + i * nloci);
+                                return 0.0;
+                            });
+                    }
+
+                wbar = sum_fitnesses(
+                    N_curr, nullptr, chunk_sums,
+                    [this, &pop, &gvalue, nloci,
+                     parallel](const std::size_t i) {
+                        pop.diploids[i][0].g = aggregator(
+                            parallel ? gvalue(locus_gvalues.data() + i * nloci)
+                                     : gvalue(pop.diploids[i], pop.gametes,
+                                              pop.mutations));
                         pop.diploids[i][0].w = trait_to_fitness(
                             pop.diploids[i][0].g, pop.diploids[i][0].e);
                         fitnesses[i] = pop.diploids[i][0].w;
-                        wbar += fitnesses[i];
-                    }
+                        return fitnesses[i];
+                    });
 
                 wbar /= double(N_curr);
 
-                /*!
-                  Black magic alert:
-                  fwdpp_internal::gsl_ran_discrete_t_ptr contains a
-                  std::unique_ptr wrapping the GSL pointer.
-                  This type has its own deleter, which is convenient, because
-                  operator= for unique_ptrs automagically calls the deleter
-                  before assignment!
-                  Details:
-                  http://www.cplusplus.com/reference/memory/unique_ptr/operator=
-
-                  This only works b/c the rhs of the expression below may be
-                  treated as an rvalue reference.
-                */
-                lookup = KTfwd::fwdpp_internal::gsl_ran_discrete_t_ptr(
-                    gsl_ran_discrete_preproc(N_curr, &fitnesses[0]));
+                lookup.assign(fitnesses.data(), N_curr, pool);
+                return wbar;
+            }
+
+            double
+            w_native_aggregator(multilocus_t &pop,
+                                const multilocus_genetic_value &gvalue) const
+            {
+                const std::size_t N_curr = pop.diploids.size();
+                if (fitnesses.size() < N_curr)
+                    fitnesses.resize(N_curr);
+                const std::size_t nloci = gvalue.size();
+                locus_gvalues.resize(N_curr * nloci);
+                aggregated.resize(N_curr);
+                sum_fitnesses(N_curr, gvalue.native ? pool : nullptr,
+                              chunk_sums,
+                              [this, &pop, &gvalue,
+                               nloci](const std::size_t i) {
+                                  gvalue.fill(pop.diploids[i], pop.gametes,
+                                              pop.mutations,
+                                              locus_gvalues.data()
+                                                  + i * nloci);
+                                  return 0.0;
+                              });
+                aggregator_kernel(locus_gvalues.data(), N_curr, nloci,
+                                  aggregated.data());
+                wbar = sum_fitnesses(
+                    N_curr,
+                    native_trait_to_fitness(trait_to_fitness) ? pool
+                                                              : nullptr,
+                    chunk_sums, [this, &pop](const std::size_t i) {
+                        auto &dip = pop.diploids[i][0];
+                        dip.g = aggregated[i];
+                        dip.w = trait_to_fitness(dip.g, dip.e);
+                        fitnesses[i] = dip.w;
+                        return fitnesses[i];
+                    });
+                wbar /= double(N_curr);
+                lookup.assign(fitnesses.data(), N_curr, pool);
                 return wbar;
             }
 
@@ -137,7 +251,7 @@ namespace fwdpy11
             inline size_t
             pick1(const GSLrng_t &rng, const multilocus_t &pop) const
             {
-                return gsl_ran_discrete(rng.get(), lookup.get());
+                return lookup(rng.get());
             }
 
             //! \brief Pick parent 2.  Parent 1's data are passed along for
@@ -149,7 +263,7 @@ namespace fwdpy11
                 return ((f == 1.)
                         || (f > 0. && gsl_rng_uniform(rng.get()) < f))
                            ? p1
-                           : gsl_ran_discrete(rng.get(), lookup.get());
+                           : lookup(rng.get());
             }
 
             //! \brief Update some property of the offspring based on
@@ -3,7 +3,8 @@
 
 #include "fwdpy11/fitness/fitness.hpp"
 #include "fwdpy11/types.hpp"
-#include <fwdpp/internal/gsl_discrete.hpp>
+#include "fwdpy11/rules/alias_sampler.hpp"
+#include "fwdpy11/thread_pool.hpp"
 #include <stdexcept>
 #include <vector>
 
@@ -12,25 +13,29 @@ namespace fwdpy11
     struct single_region_rules_base
     {
         std::vector<double> fitnesses;
-        KTfwd::fwdpp_internal::gsl_ran_discrete_t_ptr lookup;
+        alias_sampler lookup;
         double wbar;
+        //! If not nullptr, used to calculate fitnesses in parallel.
+        //! Not owned by this object.
+        thread_pool *pool;
+        //! Work space for the summation of fitnesses
+        std::vector<double> chunk_sums;
+        //! If true, all diploids have the same fitness, and
+        //! parents are chosen uniformly rather than via lookup.
+        bool uniform_fitness;
         single_region_rules_base()
-            : fitnesses(std::vector<double>()),
-              lookup(KTfwd::fwdpp_internal::gsl_ran_discrete_t_ptr(nullptr)),
-              wbar(0.0)
+            : fitnesses(std::vector<double>()), lookup(alias_sampler()),
+              wbar(0.0), pool(nullptr), chunk_sums{}, uniform_fitness(false)
         {
         }
 
         single_region_rules_base(single_region_rules_base &&) = default;
 
         single_region_rules_base(const single_region_rules_base &rhs)
-            : fitnesses(rhs.fitnesses),
-              lookup(KTfwd::fwdpp_internal::gsl_ran_discrete_t_ptr(nullptr)),
-              wbar(rhs.wbar)
+            : fitnesses(rhs.fitnesses), lookup(rhs.lookup), wbar(rhs.wbar),
+              pool(rhs.pool), chunk_sums{},
+              uniform_fitness(rhs.uniform_fitness)
         {
-            if (!fitnesses.empty())
-                lookup = KTfwd::fwdpp_internal::gsl_ran_discrete_t_ptr(
-                    gsl_ran_discrete_preproc(fitnesses.size(), &fitnesses[0]));
         }
 
         virtual ~single_region_rules_base() {}
@@ -39,21 +44,29 @@ namespace fwdpy11
             = 0;
 
         //! \brief Pick parent one
+        inline size_t
+        pick_parent(const GSLrng_t &rng, const singlepop_t &pop) const
+        {
+            return uniform_fitness
+                       ? gsl_rng_uniform_int(rng.get(), pop.diploids.size())
+                       : lookup(rng.get());
+        }
+
         virtual size_t
-        pick1(const GSLrng_t &rng, const singlepop_t &) const
+        pick1(const GSLrng_t &rng, const singlepop_t &pop) const
         {
-            return gsl_ran_discrete(rng.get(), lookup.get());
+            return pick_parent(rng, pop);
         }
 
         //! \brief Pick parent 2.  Parent 1's data are passed along for models
         //! where that is relevant
         virtual size_t
-        pick2(const GSLrng_t &rng, const singlepop_t &, const std::size_t p1,
-              const double f) const
+        pick2(const GSLrng_t &rng, const singlepop_t &pop,
+              const std::size_t p1, const double f) const
         {
             return (f == 1. || (f > 0. && gsl_rng_uniform(rng.get()) < f))
                        ? p1
-                       : gsl_ran_discrete(rng.get(), lookup.get());
+                       : pick_parent(rng, pop);
         }
 
         //! \brief Update some property of the offspring based on properties of
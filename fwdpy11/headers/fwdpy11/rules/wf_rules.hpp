@@ -6,13 +6,18 @@
 
 #include <cassert>
 #include "rules_base.hpp"
+#include "fitness_reduction.hpp"
 #include <fwdpp/fitness_models.hpp>
+#include <fwdpy11/fitness/builtin_dispatch.hpp>
 
 namespace fwdpy11
 {
-    struct wf_rules : public fwdpy11::single_region_rules_base
+    struct wf_rules final : public fwdpy11::single_region_rules_base
     /*!
       \note This type is very much under development.
+
+      \note This type is final so that calls to its member
+      functions via a wf_rules & are not dispatched virtually.
     */
     {
         using base_t = fwdpy11::single_region_rules_base;
@@ -32,33 +37,76 @@ namespace fwdpy11
         {
         }
 
-        virtual double
-        w(singlepop_t &pop, const single_locus_fitness_fxn &ff)
+        static bool
+        no_selected_mutations(const singlepop_t &pop)
+        //! True if no extant gamete carries a selected mutation
+        {
+            for (const auto &g : pop.gametes)
+                {
+                    if (g.n && !g.smutations.empty())
+                        return false;
+                }
+            return true;
+        }
+
+        template <typename fitness_fxn>
+        inline double
+        w(singlepop_t &pop, const fitness_fxn &ff)
+        /*!
+          Calculate fitness for each diploid.  This template
+          is called directly when ff is one of the built-in
+          types, allowing ff to be inlined.
+
+          If pool is set and ff is one of the built-in types,
+          fitnesses are calculated in parallel.
+
+          If ff is a built-in fitness model and no selected mutations
+          are segregating, every fitness is 1.  In that case, ff is
+          not called, no lookup table is built, and parents are
+          chosen uniformly.
+        */
         {
             auto N_curr = pop.diploids.size();
+            if (neutral_fitness_is_one<fitness_fxn>::value
+                && no_selected_mutations(pop))
+                {
+                    for (auto &dip : pop.diploids)
+                        {
+                            dip.w = dip.g = 1.0;
+                        }
+                    uniform_fitness = true;
+                    wbar = 1.0;
+                    return wbar;
+                }
+            uniform_fitness = false;
             if (fitnesses.size() < N_curr)
                 fitnesses.resize(N_curr);
-            wbar = 0.;
-            for (size_t i = 0; i < N_curr; ++i)
-                {
+            wbar = sum_fitnesses(
+                N_curr, is_native_fitness<fitness_fxn>::value ? pool : nullptr,
+                chunk_sums, [this, &pop, &ff](const std::size_t i) {
                     pop.diploids[i].w = pop.diploids[i].g
                         = ff(pop.diploids[i], pop.gametes, pop.mutations);
                     assert(std::isfinite(pop.diploids[i].w));
                     fitnesses[i] = pop.diploids[i].w;
-                    wbar += pop.diploids[i].w;
-                }
+                    return fitnesses[i];
+                });
             wbar /= double(N_curr);
-            lookup = KTfwd::fwdpp_internal::gsl_ran_discrete_t_ptr(
-                gsl_ran_discrete_preproc(N_curr, &fitnesses[0]));
+            lookup.assign(fitnesses.data(), N_curr, pool);
             return wbar;
         }
 
+        double
+        w(singlepop_t &pop, const single_locus_fitness_fxn &ff) override
+        {
+            return this->w<single_locus_fitness_fxn>(pop, ff);
+        }
+
         //! \brief Update some property of the offspring based on properties of
         //! the parents
-        virtual void
+        void
         update(const GSLrng_t &rng, diploid_t &offspring,
                const singlepop_t &pop, const std::size_t p1,
-               const std::size_t p2) noexcept
+               const std::size_t p2) noexcept override
         {
             offspring.e = 0.0;
             offspring.g = 0.0;
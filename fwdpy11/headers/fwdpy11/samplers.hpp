@@ -20,7 +20,10 @@
 #define FWDPY11_SAMPLERS_HPP__
 
 #include <functional>
+#include <pybind11/pybind11.h>
+#include <pybind11/functional.h>
 #include <fwdpy11/types.hpp>
+#include <fwdpy11/recorders.hpp>
 
 namespace fwdpy11
 {
@@ -31,6 +34,31 @@ namespace fwdpy11
     // Applied each generation to record any data of interest.
     using multilocus_temporal_sampler
         = std::function<void(const fwdpy11::multilocus_t&)>;
+
+    template <typename poptype>
+    inline std::function<void(const poptype&)>
+    make_temporal_sampler(pybind11::object recorder)
+    /*!
+      Convert the recorder passed to an evolve function.
+
+      Instances of fwdpy11::native_recorder are called directly.
+      Anything else is cast to a std::function, meaning that each
+      call goes through Python.  In the former case, the return
+      value refers to the object held by \a recorder, which must
+      therefore outlive it.
+    */
+    {
+        if (recorder == pybind11::none())
+            {
+                return [](const poptype&) {};
+            }
+        if (pybind11::isinstance<native_recorder>(recorder))
+            {
+                auto& r = recorder.cast<native_recorder&>();
+                return [&r](const poptype& pop) { r(pop); };
+            }
+        return recorder.cast<std::function<void(const poptype&)>>();
+    }
 }
 
 #endif
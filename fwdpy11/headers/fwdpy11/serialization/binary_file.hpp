@@ -0,0 +1,1096 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_SERIALIZATION_BINARY_FILE_HPP__
+#define FWDPY11_SERIALIZATION_BINARY_FILE_HPP__
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fwdpy11/types.hpp>
+
+namespace fwdpy11
+{
+    namespace serialization
+    {
+        /*!
+          A sectioned, binary file format for populations.
+
+          The file starts with a file_header, followed by a table of
+          nsections section_entry records.  Each section is an array of
+          fixed-size records, starting at an offset that is a multiple
+          of 8 bytes.  Variable-length data (mutation keys in gametes,
+          the values of KTfwd::generalmut_vec) are stored in separate
+          sections and referred to by offset.
+
+          Data are written incrementally via a small buffer, so that
+          the whole population is never copied in memory.  Files are
+          read by mapping them into memory, and the population is
+          built directly from the mapped records.
+
+          Data are stored in native byte order, and files are not
+          portable across machines with different byte orders.
+        */
+        namespace binary
+        {
+            inline constexpr std::uint32_t
+            format_version()
+            {
+                return 1;
+            }
+
+            enum class population_type : std::uint32_t
+            {
+                slocus = 1,
+                mlocus = 2,
+                slocus_gm_vec = 3
+            };
+
+            enum class section : std::uint32_t
+            {
+                metadata = 1,
+                mutations,
+                mutation_values,
+                mcounts,
+                fixations,
+                fixation_values,
+                fixation_times,
+                gametes,
+                gamete_keys,
+                diploids,
+                locus_boundaries
+            };
+
+            //! Number of sections written for every population type
+            constexpr std::uint32_t nsections = 11;
+
+            struct file_header
+            {
+                char magic[4];
+                std::uint32_t version;
+                //! Always 1, used to detect files from other platforms
+                std::uint32_t byte_order;
+                std::uint32_t poptype;
+                std::uint32_t nsections;
+                std::uint32_t reserved;
+            };
+
+            struct section_entry
+            {
+                std::uint32_t id;
+                std::uint32_t record_size;
+                std::uint64_t offset;
+                std::uint64_t count;
+            };
+
+            struct metadata_record
+            {
+                std::uint32_t generation;
+                std::uint32_t N;
+                std::uint32_t nloci;
+                std::uint32_t reserved;
+            };
+
+            struct mutation_record
+            {
+                double pos, s, h;
+                std::uint32_t g;
+                std::uint16_t label;
+                std::uint8_t neutral, reserved;
+            };
+
+            struct general_mutation_record
+            /*!
+              s and h are stored contiguously in the values section,
+              starting at values_offset.
+            */
+            {
+                double pos;
+                std::uint64_t values_offset;
+                std::uint32_t ns, nh;
+                std::uint32_t g;
+                std::uint16_t label;
+                std::uint8_t neutral, reserved;
+            };
+
+            struct gamete_record
+            /*!
+              Neutral, then selected, keys are stored contiguously in
+              the gamete_keys section, starting at keys_offset.
+            */
+            {
+                std::uint64_t keys_offset;
+                std::uint32_t n;
+                std::uint32_t nneutral;
+                std::uint32_t nselected;
+                std::uint32_t reserved;
+            };
+
+            struct diploid_record
+            {
+                std::uint64_t first, second, label;
+                double g, e, w;
+            };
+
+            struct locus_boundary_record
+            {
+                double beg, end;
+            };
+
+            inline void
+            throw_io_error(const std::string &what,
+                           const std::string &filename)
+            {
+                throw std::runtime_error(what + " " + filename + ": "
+                                         + std::strerror(errno));
+            }
+
+            class file_writer
+            /*!
+              Buffered, sequential output to a file descriptor.
+            */
+            {
+              private:
+                std::string filename;
+                std::vector<char> buffer;
+                std::uint64_t offset;
+                int fd;
+
+                static constexpr std::size_t buffer_size = 1 << 20;
+
+                void
+                write_fd(const char *data, std::size_t n)
+                {
+                    while (n > 0)
+                        {
+                            auto written = ::write(fd, data, n);
+                            if (written < 0)
+                                {
+                                    if (errno == EINTR)
+                                        continue;
+                                    throw_io_error("error writing to",
+                                                   filename);
+                                }
+                            data += written;
+                            n -= static_cast<std::size_t>(written);
+                        }
+                }
+
+              public:
+                explicit file_writer(const char *filename_)
+                    : filename(filename_), buffer{}, offset(0),
+                      fd(::open(filename_, O_WRONLY | O_CREAT | O_TRUNC,
+                                0644))
+                {
+                    if (fd < 0)
+                        {
+                            throw_io_error("could not open", filename);
+                        }
+                    buffer.reserve(buffer_size);
+                }
+
+                file_writer(const file_writer &) = delete;
+                file_writer &operator=(const file_writer &) = delete;
+
+                ~file_writer()
+                {
+                    if (fd >= 0)
+                        ::close(fd);
+                }
+
+                inline std::uint64_t
+                tell() const
+                {
+                    return offset;
+                }
+
+                void
+                flush()
+                {
+                    write_fd(buffer.data(), buffer.size());
+                    buffer.clear();
+                }
+
+                void
+                write(const void *data, const std::size_t n)
+                {
+                    auto p = static_cast<const char *>(data);
+                    if (buffer.size() + n > buffer_size)
+                        {
+                            flush();
+                        }
+                    if (n >= buffer_size)
+                        {
+                            write_fd(p, n);
+                        }
+                    else
+                        {
+                            buffer.insert(buffer.end(), p, p + n);
+                        }
+                    offset += n;
+                }
+
+                void
+                align()
+                //! Pad the output to a multiple of 8 bytes
+                {
+                    static const char zeros[8] = { 0 };
+                    if (offset % 8)
+                        {
+                            write(zeros, 8 - offset % 8);
+                        }
+                }
+
+                void
+                write_at(const std::uint64_t pos, const void *data,
+                         std::size_t n)
+                //! Overwrite data previously written at \a pos
+                {
+                    flush();
+                    auto p = static_cast<const char *>(data);
+                    auto where = static_cast<off_t>(pos);
+                    while (n > 0)
+                        {
+                            auto written = ::pwrite(fd, p, n, where);
+                            if (written < 0)
+                                {
+                                    if (errno == EINTR)
+                                        continue;
+                                    throw_io_error("error writing to",
+                                                   filename);
+                                }
+                            p += written;
+                            where += written;
+                            n -= static_cast<std::size_t>(written);
+                        }
+                }
+
+                void
+                close()
+                {
+                    flush();
+                    auto rv = ::close(fd);
+                    fd = -1;
+                    if (rv != 0)
+                        {
+                            throw_io_error("error closing", filename);
+                        }
+                }
+            };
+
+            class mapped_file
+            //! Read-only memory map of an entire file
+            {
+              private:
+                const char *addr;
+                std::size_t len;
+
+              public:
+                explicit mapped_file(const char *filename)
+                    : addr(nullptr), len(0)
+                {
+                    int fd = ::open(filename, O_RDONLY);
+                    if (fd < 0)
+                        {
+                            throw_io_error("could not open", filename);
+                        }
+                    struct stat st;
+                    if (::fstat(fd, &st) != 0)
+                        {
+                            const int e = errno;
+                            ::close(fd);
+                            errno = e;
+                            throw_io_error("could not stat", filename);
+                        }
+                    len = static_cast<std::size_t>(st.st_size);
+                    if (len < sizeof(file_header))
+                        {
+                            ::close(fd);
+                            throw std::invalid_argument(
+                                std::string(filename)
+                                + " is not an fp11 population file");
+                        }
+                    void *p = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE,
+                                     fd, 0);
+                    const int e = errno;
+                    ::close(fd);
+                    if (p == MAP_FAILED)
+                        {
+                            errno = e;
+                            throw_io_error("could not map", filename);
+                        }
+                    addr = static_cast<const char *>(p);
+                }
+
+                mapped_file(const mapped_file &) = delete;
+                mapped_file &operator=(const mapped_file &) = delete;
+
+                ~mapped_file()
+                {
+                    if (addr != nullptr)
+                        ::munmap(const_cast<char *>(addr), len);
+                }
+
+                inline const char *
+                data() const
+                {
+                    return addr;
+                }
+
+                inline std::size_t
+                size() const
+                {
+                    return len;
+                }
+            };
+
+            template <typename T> struct section_view
+            //! The records of a section of a mapped file
+            {
+                const T *first;
+                std::size_t count;
+
+                inline const T *
+                begin() const
+                {
+                    return first;
+                }
+                inline const T *
+                end() const
+                {
+                    return first + count;
+                }
+                inline std::size_t
+                size() const
+                {
+                    return count;
+                }
+                inline const T &operator[](const std::size_t i) const
+                {
+                    return first[i];
+                }
+            };
+
+            class population_file
+            /*!
+              A mapped population file whose header and section
+              table have been validated.  Sections are only
+              touched when requested, so that reading part of a
+              file only pages in that part.
+            */
+            {
+              private:
+                std::string filename;
+                mapped_file file;
+                file_header header;
+                std::vector<section_entry> sections;
+
+                void
+                bad_file(const std::string &why) const
+                {
+                    throw std::invalid_argument(
+                        filename + " is not a valid fp11 population file: "
+                        + why);
+                }
+
+              public:
+                explicit population_file(const char *filename_)
+                    : filename(filename_), file(filename_), header{},
+                      sections{}
+                {
+                    std::memcpy(&header, file.data(), sizeof(file_header));
+                    if (std::memcmp(header.magic, "fp11", 4) != 0)
+                        {
+                            bad_file("incorrect magic number");
+                        }
+                    if (header.byte_order != 1)
+                        {
+                            bad_file("incompatible byte order");
+                        }
+                    if (header.version != format_version())
+                        {
+                            bad_file("unsupported format version "
+                                     + std::to_string(header.version));
+                        }
+                    const std::size_t table_end
+                        = sizeof(file_header)
+                          + std::size_t(header.nsections)
+                                * sizeof(section_entry);
+                    if (table_end > file.size())
+                        {
+                            bad_file("truncated section table");
+                        }
+                    sections.resize(header.nsections);
+                    std::memcpy(sections.data(),
+                                file.data() + sizeof(file_header),
+                                sections.size() * sizeof(section_entry));
+                    for (const auto &s : sections)
+                        {
+                            if (s.record_size == 0 || s.offset % 8
+                                || s.offset > file.size()
+                                || s.count > (file.size() - s.offset)
+                                                 / s.record_size)
+                                {
+                                    bad_file("section "
+                                             + std::to_string(s.id)
+                                             + " is out of bounds");
+                                }
+                        }
+                }
+
+                inline const std::string &
+                name() const
+                {
+                    return filename;
+                }
+
+                inline std::uint32_t
+                population_type() const
+                {
+                    return header.poptype;
+                }
+
+                bool
+                has_section(const section id) const
+                {
+                    for (const auto &s : sections)
+                        {
+                            if (s.id == static_cast<std::uint32_t>(id))
+                                return true;
+                        }
+                    return false;
+                }
+
+                std::size_t
+                count(const section id) const
+                //! The number of records in a section, or zero if missing
+                {
+                    for (const auto &s : sections)
+                        {
+                            if (s.id == static_cast<std::uint32_t>(id))
+                                return static_cast<std::size_t>(s.count);
+                        }
+                    return 0;
+                }
+
+                template <typename T>
+                section_view<T>
+                records(const section id) const
+                /*!
+                  \throw std::invalid_argument if the section is
+                  missing or its records are not of type T.
+                */
+                {
+                    for (const auto &s : sections)
+                        {
+                            if (s.id != static_cast<std::uint32_t>(id))
+                                continue;
+                            if (s.record_size != sizeof(T))
+                                {
+                                    bad_file("unexpected record size in "
+                                             "section "
+                                             + std::to_string(s.id));
+                                }
+                            return section_view<T>{
+                                reinterpret_cast<const T *>(file.data()
+                                                            + s.offset),
+                                static_cast<std::size_t>(s.count)
+                            };
+                        }
+                    bad_file("missing section "
+                             + std::to_string(static_cast<std::uint32_t>(id)));
+                    return section_view<T>{ nullptr, 0 };
+                }
+
+                metadata_record
+                metadata() const
+                {
+                    auto m = records<metadata_record>(section::metadata);
+                    if (m.size() != 1)
+                        {
+                            bad_file("invalid metadata");
+                        }
+                    return m[0];
+                }
+
+                void
+                check(const bool condition, const char *why) const
+                //! Report an inconsistency in the contents of the file
+                {
+                    if (!condition)
+                        bad_file(why);
+                }
+            };
+
+            template <typename poptype> struct population_traits;
+
+            template <> struct population_traits<singlepop_t>
+            {
+                static binary::population_type
+                type()
+                {
+                    return binary::population_type::slocus;
+                }
+                static unsigned
+                nloci(const singlepop_t &)
+                {
+                    return 1;
+                }
+                static std::vector<std::pair<double, double>>
+                locus_boundaries(const singlepop_t &)
+                {
+                    return {};
+                }
+                static singlepop_t
+                make(const metadata_record &m)
+                {
+                    return singlepop_t(m.N);
+                }
+                static void
+                set_locus_boundaries(singlepop_t &,
+                                     std::vector<std::pair<double, double>>)
+                {
+                }
+            };
+
+            template <> struct population_traits<singlepop_gm_vec_t>
+            {
+                static binary::population_type
+                type()
+                {
+                    return binary::population_type::slocus_gm_vec;
+                }
+                static unsigned
+                nloci(const singlepop_gm_vec_t &)
+                {
+                    return 1;
+                }
+                static std::vector<std::pair<double, double>>
+                locus_boundaries(const singlepop_gm_vec_t &)
+                {
+                    return {};
+                }
+                static singlepop_gm_vec_t
+                make(const metadata_record &m)
+                {
+                    return singlepop_gm_vec_t(m.N);
+                }
+                static void
+                set_locus_boundaries(singlepop_gm_vec_t &,
+                                     std::vector<std::pair<double, double>>)
+                {
+                }
+            };
+
+            template <> struct population_traits<multilocus_t>
+            {
+                static binary::population_type
+                type()
+                {
+                    return binary::population_type::mlocus;
+                }
+                static unsigned
+                nloci(const multilocus_t &pop)
+                {
+                    return pop.nloci;
+                }
+                static std::vector<std::pair<double, double>>
+                locus_boundaries(const multilocus_t &pop)
+                {
+                    return pop.locus_boundaries;
+                }
+                static multilocus_t
+                make(const metadata_record &m)
+                {
+                    return multilocus_t(m.N, m.nloci);
+                }
+                static void
+                set_locus_boundaries(
+                    multilocus_t &pop,
+                    std::vector<std::pair<double, double>> boundaries)
+                {
+                    pop.locus_boundaries.swap(boundaries);
+                }
+            };
+
+            namespace detail
+            {
+                inline void
+                begin_section(file_writer &w,
+                              std::vector<section_entry> &table,
+                              const section id,
+                              const std::uint32_t record_size)
+                {
+                    w.align();
+                    table.push_back(
+                        section_entry{ static_cast<std::uint32_t>(id),
+                                       record_size, w.tell(), 0 });
+                }
+
+                inline void
+                end_section(const file_writer &w,
+                            std::vector<section_entry> &table)
+                {
+                    auto &s = table.back();
+                    s.count = (w.tell() - s.offset) / s.record_size;
+                }
+
+                template <typename T>
+                inline void
+                write_array(file_writer &w, std::vector<section_entry> &table,
+                            const section id, const std::vector<T> &v)
+                {
+                    begin_section(w, table, id, sizeof(T));
+                    w.write(v.data(), v.size() * sizeof(T));
+                    end_section(w, table);
+                }
+
+                template <typename T>
+                inline void
+                read_array(const population_file &f, const section id,
+                           std::vector<T> &v)
+                {
+                    auto r = f.records<T>(id);
+                    v.assign(r.begin(), r.end());
+                }
+
+                inline void
+                write_mutations(file_writer &w,
+                                std::vector<section_entry> &table,
+                                const section records_id,
+                                const section values_id,
+                                const std::vector<KTfwd::popgenmut> &mutations)
+                {
+                    begin_section(w, table, records_id,
+                                  sizeof(mutation_record));
+                    for (const auto &m : mutations)
+                        {
+                            const mutation_record r{
+                                m.pos,
+                                m.s,
+                                m.h,
+                                static_cast<std::uint32_t>(m.g),
+                                m.xtra,
+                                static_cast<std::uint8_t>(m.neutral),
+                                0
+                            };
+                            w.write(&r, sizeof(mutation_record));
+                        }
+                    end_section(w, table);
+                    begin_section(w, table, values_id, sizeof(double));
+                    end_section(w, table);
+                }
+
+                inline void
+                write_mutations(
+                    file_writer &w, std::vector<section_entry> &table,
+                    const section records_id, const section values_id,
+                    const std::vector<KTfwd::generalmut_vec> &mutations)
+                {
+                    begin_section(w, table, records_id,
+                                  sizeof(general_mutation_record));
+                    std::uint64_t values_offset = 0;
+                    for (const auto &m : mutations)
+                        {
+                            const general_mutation_record r{
+                                m.pos,
+                                values_offset,
+                                static_cast<std::uint32_t>(m.s.size()),
+                                static_cast<std::uint32_t>(m.h.size()),
+                                static_cast<std::uint32_t>(m.g),
+                                m.xtra,
+                                static_cast<std::uint8_t>(m.neutral),
+                                0
+                            };
+                            w.write(&r, sizeof(general_mutation_record));
+                            values_offset += m.s.size() + m.h.size();
+                        }
+                    end_section(w, table);
+                    begin_section(w, table, values_id, sizeof(double));
+                    for (const auto &m : mutations)
+                        {
+                            w.write(m.s.data(), m.s.size() * sizeof(double));
+                            w.write(m.h.data(), m.h.size() * sizeof(double));
+                        }
+                    end_section(w, table);
+                }
+
+                inline void
+                read_mutations(const population_file &f,
+                               const section records_id, const section,
+                               std::vector<KTfwd::popgenmut> &mutations)
+                {
+                    auto records = f.records<mutation_record>(records_id);
+                    mutations.clear();
+                    mutations.reserve(records.size());
+                    for (const auto &r : records)
+                        {
+                            mutations.emplace_back(r.pos, r.s, r.h, r.g,
+                                                   r.label);
+                            mutations.back().neutral = (r.neutral != 0);
+                        }
+                }
+
+                inline void
+                read_mutations(const population_file &f,
+                               const section records_id,
+                               const section values_id,
+                               std::vector<KTfwd::generalmut_vec> &mutations)
+                {
+                    auto records
+                        = f.records<general_mutation_record>(records_id);
+                    auto values = f.records<double>(values_id);
+                    mutations.clear();
+                    mutations.reserve(records.size());
+                    for (const auto &r : records)
+                        {
+                            f.check(r.values_offset <= values.size()
+                                        && std::uint64_t(r.ns) + r.nh
+                                               <= values.size()
+                                                      - r.values_offset,
+                                    "mutation values out of range");
+                            auto s = values.begin() + r.values_offset;
+                            auto h = s + r.ns;
+                            mutations.emplace_back(
+                                std::vector<double>(s, h),
+                                std::vector<double>(h, h + r.nh), r.pos, r.g,
+                                r.label);
+                            mutations.back().neutral = (r.neutral != 0);
+                        }
+                }
+
+                template <typename gcont_t>
+                inline void
+                write_gametes(file_writer &w,
+                              std::vector<section_entry> &table,
+                              const gcont_t &gametes)
+                {
+                    begin_section(w, table, section::gametes,
+                                  sizeof(gamete_record));
+                    std::uint64_t keys_offset = 0;
+                    for (const auto &g : gametes)
+                        {
+                            const gamete_record r{
+                                keys_offset, static_cast<std::uint32_t>(g.n),
+                                static_cast<std::uint32_t>(g.mutations.size()),
+                                static_cast<std::uint32_t>(
+                                    g.smutations.size()),
+                                0
+                            };
+                            w.write(&r, sizeof(gamete_record));
+                            keys_offset
+                                += g.mutations.size() + g.smutations.size();
+                        }
+                    end_section(w, table);
+                    begin_section(w, table, section::gamete_keys,
+                                  sizeof(KTfwd::uint_t));
+                    for (const auto &g : gametes)
+                        {
+                            w.write(g.mutations.data(),
+                                    g.mutations.size()
+                                        * sizeof(KTfwd::uint_t));
+                            w.write(g.smutations.data(),
+                                    g.smutations.size()
+                                        * sizeof(KTfwd::uint_t));
+                        }
+                    end_section(w, table);
+                }
+
+                template <typename gamete_t>
+                inline gamete_t
+                read_gamete(const population_file &f, const gamete_record &r,
+                            const section_view<KTfwd::uint_t> &keys,
+                            const std::size_t nmutations)
+                {
+                    f.check(r.keys_offset <= keys.size()
+                                && std::uint64_t(r.nneutral) + r.nselected
+                                       <= keys.size() - r.keys_offset,
+                            "gamete keys out of range");
+                    auto n = keys.begin() + r.keys_offset;
+                    auto s = n + r.nneutral;
+                    auto e = s + r.nselected;
+                    for (auto k = n; k < e; ++k)
+                        {
+                            f.check(*k < nmutations,
+                                    "mutation key out of range");
+                        }
+                    return gamete_t(r.n, std::vector<KTfwd::uint_t>(n, s),
+                                    std::vector<KTfwd::uint_t>(s, e));
+                }
+
+                template <typename gcont_t>
+                inline void
+                read_gametes(const population_file &f, gcont_t &gametes,
+                             const std::size_t nmutations)
+                {
+                    using gamete_t = typename gcont_t::value_type;
+                    auto records = f.records<gamete_record>(section::gametes);
+                    auto keys = f.records<KTfwd::uint_t>(section::gamete_keys);
+                    gametes.clear();
+                    gametes.reserve(records.size());
+                    for (const auto &r : records)
+                        {
+                            gametes.emplace_back(
+                                read_gamete<gamete_t>(f, r, keys, nmutations));
+                        }
+                }
+
+                inline diploid_record
+                make_record(const diploid_t &d)
+                {
+                    return diploid_record{ d.first, d.second, d.label,
+                                           d.g,     d.e,      d.w };
+                }
+
+                inline diploid_t
+                make_diploid(const population_file &f, const diploid_record &r,
+                             const std::size_t ngametes)
+                {
+                    f.check(r.first < ngametes && r.second < ngametes,
+                            "gamete index out of range");
+                    diploid_t d(r.first, r.second);
+                    d.label = r.label;
+                    d.g = r.g;
+                    d.e = r.e;
+                    d.w = r.w;
+                    return d;
+                }
+
+                inline void
+                write_diploids(file_writer &w,
+                               std::vector<section_entry> &table,
+                               const dipvector_t &diploids)
+                {
+                    begin_section(w, table, section::diploids,
+                                  sizeof(diploid_record));
+                    for (const auto &d : diploids)
+                        {
+                            const auto r = make_record(d);
+                            w.write(&r, sizeof(diploid_record));
+                        }
+                    end_section(w, table);
+                }
+
+                inline void
+                write_diploids(
+                    file_writer &w, std::vector<section_entry> &table,
+                    const std::vector<multilocus_diploid_t> &diploids)
+                //! Written row-major, one row per individual
+                {
+                    begin_section(w, table, section::diploids,
+                                  sizeof(diploid_record));
+                    for (const auto &dip : diploids)
+                        {
+                            for (const auto &d : dip)
+                                {
+                                    const auto r = make_record(d);
+                                    w.write(&r, sizeof(diploid_record));
+                                }
+                        }
+                    end_section(w, table);
+                }
+
+                inline void
+                append_diploid(const population_file &f,
+                               const diploid_record *records,
+                               const unsigned nloci,
+                               const std::size_t ngametes,
+                               dipvector_t &diploids)
+                {
+                    f.check(nloci == 1, "wrong number of loci");
+                    diploids.push_back(
+                        make_diploid(f, records[0], ngametes));
+                }
+
+                inline void
+                append_diploid(const population_file &f,
+                               const diploid_record *records,
+                               const unsigned nloci,
+                               const std::size_t ngametes,
+                               std::vector<multilocus_diploid_t> &diploids)
+                {
+                    multilocus_diploid_t dip;
+                    dip.reserve(nloci);
+                    for (unsigned i = 0; i < nloci; ++i)
+                        {
+                            dip.push_back(
+                                make_diploid(f, records[i], ngametes));
+                        }
+                    diploids.emplace_back(std::move(dip));
+                }
+
+                template <typename dipcont_t>
+                inline void
+                read_diploids(const population_file &f,
+                              const metadata_record &m,
+                              const std::size_t ngametes,
+                              dipcont_t &diploids)
+                {
+                    auto records
+                        = f.records<diploid_record>(section::diploids);
+                    f.check(m.nloci > 0
+                                && records.size()
+                                       == std::size_t(m.N) * m.nloci,
+                            "wrong number of diploids");
+                    diploids.clear();
+                    diploids.reserve(m.N);
+                    for (std::size_t i = 0; i < m.N; ++i)
+                        {
+                            append_diploid(f, &records[i * m.nloci], m.nloci,
+                                           ngametes, diploids);
+                        }
+                }
+
+                template <typename poptype>
+                poptype
+                read_population(const population_file &f)
+                {
+                    using traits = population_traits<poptype>;
+                    if (f.population_type()
+                        != static_cast<std::uint32_t>(traits::type()))
+                        {
+                            throw std::invalid_argument(
+                                f.name()
+                                + " contains a different population type");
+                        }
+                    const auto m = f.metadata();
+                    f.check(m.N > 0, "population size is zero");
+                    poptype pop(traits::make(m));
+                    pop.generation = m.generation;
+                    read_mutations(f, section::mutations,
+                                   section::mutation_values, pop.mutations);
+                    read_array(f, section::mcounts, pop.mcounts);
+                    f.check(pop.mcounts.size() == pop.mutations.size(),
+                            "mutations and mcounts differ in length");
+                    read_mutations(f, section::fixations,
+                                   section::fixation_values, pop.fixations);
+                    read_array(f, section::fixation_times,
+                               pop.fixation_times);
+                    read_gametes(f, pop.gametes, pop.mutations.size());
+                    read_diploids(f, m, pop.gametes.size(), pop.diploids);
+                    std::vector<std::pair<double, double>> boundaries;
+                    for (const auto &b : f.records<locus_boundary_record>(
+                             section::locus_boundaries))
+                        {
+                            boundaries.emplace_back(b.beg, b.end);
+                        }
+                    traits::set_locus_boundaries(pop, std::move(boundaries));
+
+                    pop.mut_lookup.clear();
+                    for (std::size_t i = 0; i < pop.mcounts.size(); ++i)
+                        {
+                            if (pop.mcounts[i])
+                                {
+                                    pop.mut_lookup.insert(
+                                        pop.mutations[i].pos);
+                                }
+                        }
+                    return pop;
+                }
+            }
+
+            template <typename poptype>
+            void
+            tofile(const poptype &pop, const char *filename)
+            /*!
+              Write \a pop to \a filename, replacing any existing file.
+
+              \throw std::runtime_error if the file cannot be written
+            */
+            {
+                using traits = population_traits<poptype>;
+                file_writer w(filename);
+                const file_header header{
+                    { 'f', 'p', '1', '1' },
+                    format_version(),
+                    1,
+                    static_cast<std::uint32_t>(traits::type()),
+                    nsections,
+                    0
+                };
+                w.write(&header, sizeof(file_header));
+                const auto table_offset = w.tell();
+                std::vector<section_entry> table(nsections);
+                w.write(table.data(), table.size() * sizeof(section_entry));
+                table.clear();
+
+                detail::begin_section(w, table, section::metadata,
+                                      sizeof(metadata_record));
+                const metadata_record metadata{ pop.generation, pop.N,
+                                                traits::nloci(pop), 0 };
+                w.write(&metadata, sizeof(metadata_record));
+                detail::end_section(w, table);
+
+                detail::write_mutations(w, table, section::mutations,
+                                        section::mutation_values,
+                                        pop.mutations);
+                detail::write_array(w, table, section::mcounts, pop.mcounts);
+                detail::write_mutations(w, table, section::fixations,
+                                        section::fixation_values,
+                                        pop.fixations);
+                detail::write_array(w, table, section::fixation_times,
+                                    pop.fixation_times);
+                detail::write_gametes(w, table, pop.gametes);
+                detail::write_diploids(w, table, pop.diploids);
+
+                detail::begin_section(w, table, section::locus_boundaries,
+                                      sizeof(locus_boundary_record));
+                for (const auto &b : traits::locus_boundaries(pop))
+                    {
+                        const locus_boundary_record r{ b.first, b.second };
+                        w.write(&r, sizeof(locus_boundary_record));
+                    }
+                detail::end_section(w, table);
+
+                if (table.size() != nsections)
+                    {
+                        throw std::logic_error(
+                            "incorrect number of sections written");
+                    }
+                w.write_at(table_offset, table.data(),
+                           table.size() * sizeof(section_entry));
+                w.close();
+            }
+
+            template <typename poptype>
+            poptype
+            fromfile(const char *filename)
+            /*!
+              Read a population written by tofile.
+
+              \throw std::invalid_argument if the file is not valid,
+              or contains a different population type.
+              \throw std::runtime_error if the file cannot be read.
+            */
+            {
+                return detail::read_population<poptype>(
+                    population_file(filename));
+            }
+        }
+    }
+}
+
+#endif
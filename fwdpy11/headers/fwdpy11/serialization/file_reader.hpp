@@ -0,0 +1,196 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_SERIALIZATION_FILE_READER_HPP__
+#define FWDPY11_SERIALIZATION_FILE_READER_HPP__
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "binary_file.hpp"
+
+namespace fwdpy11
+{
+    namespace serialization
+    {
+        namespace binary
+        {
+            class population_file_reader
+            /*!
+              Reads parts of a file written by tofile.
+
+              Opening a file only reads its header and section table.
+              Each member function then reads a single section, or,
+              for diploids and gametes, only the records for the
+              requested individuals.  Thus, the cost of reading part
+              of a population is independent of the size of the rest
+              of the population.
+            */
+            {
+              private:
+                population_file f;
+                metadata_record m;
+
+                void
+                check_index(const std::size_t i) const
+                {
+                    if (i >= m.N)
+                        {
+                            throw std::out_of_range(
+                                "diploid index out of range");
+                        }
+                }
+
+              public:
+                explicit population_file_reader(const std::string &filename)
+                    : f(filename.c_str()), m(f.metadata())
+                {
+                }
+
+                inline std::uint32_t
+                population_type() const
+                {
+                    return f.population_type();
+                }
+
+                inline const metadata_record &
+                metadata() const
+                {
+                    return m;
+                }
+
+                template <typename mcont_t>
+                mcont_t
+                mutations() const
+                {
+                    mcont_t rv;
+                    detail::read_mutations(f, section::mutations,
+                                           section::mutation_values, rv);
+                    return rv;
+                }
+
+                template <typename mcont_t>
+                mcont_t
+                fixations() const
+                {
+                    mcont_t rv;
+                    detail::read_mutations(f, section::fixations,
+                                           section::fixation_values, rv);
+                    return rv;
+                }
+
+                std::vector<KTfwd::uint_t>
+                mcounts() const
+                {
+                    std::vector<KTfwd::uint_t> rv;
+                    detail::read_array(f, section::mcounts, rv);
+                    return rv;
+                }
+
+                std::vector<KTfwd::uint_t>
+                fixation_times() const
+                {
+                    std::vector<KTfwd::uint_t> rv;
+                    detail::read_array(f, section::fixation_times, rv);
+                    return rv;
+                }
+
+                template <typename dipcont_t>
+                dipcont_t
+                diploids(const std::vector<std::size_t> &indexes) const
+                /*!
+                  The diploids at \a indexes, in that order.  For
+                  multi-locus populations, dipcont_t is a vector of
+                  per-locus vectors.
+
+                  \throw std::out_of_range if an index is >= N
+                */
+                {
+                    auto records
+                        = f.records<diploid_record>(section::diploids);
+                    f.check(records.size() == std::size_t(m.N) * m.nloci,
+                            "wrong number of diploids");
+                    const auto ngametes = f.count(section::gametes);
+                    dipcont_t rv;
+                    rv.reserve(indexes.size());
+                    for (auto i : indexes)
+                        {
+                            check_index(i);
+                            detail::append_diploid(
+                                f, &records[i * m.nloci], m.nloci, ngametes,
+                                rv);
+                        }
+                    return rv;
+                }
+
+                gcont_t
+                gametes(const std::vector<std::size_t> &indexes) const
+                /*!
+                  The gametes of the diploids at \a indexes.  For each
+                  individual and locus, the first and second gametes are
+                  returned, so that there are 2*nloci gametes per
+                  individual.  Mutation keys refer to the mutations
+                  section of the file.
+
+                  \throw std::out_of_range if an index is >= N
+                */
+                {
+                    auto diploids
+                        = f.records<diploid_record>(section::diploids);
+                    f.check(diploids.size() == std::size_t(m.N) * m.nloci,
+                            "wrong number of diploids");
+                    auto gametes = f.records<gamete_record>(section::gametes);
+                    auto keys = f.records<KTfwd::uint_t>(section::gamete_keys);
+                    const auto nmutations = f.count(section::mutations);
+                    gcont_t rv;
+                    rv.reserve(2 * m.nloci * indexes.size());
+                    for (auto i : indexes)
+                        {
+                            check_index(i);
+                            for (unsigned l = 0; l < m.nloci; ++l)
+                                {
+                                    const auto &d = diploids[i * m.nloci + l];
+                                    f.check(d.first < gametes.size()
+                                                && d.second < gametes.size(),
+                                            "gamete index out of range");
+                                    rv.emplace_back(detail::read_gamete<
+                                                    gamete_t>(
+                                        f, gametes[d.first], keys,
+                                        nmutations));
+                                    rv.emplace_back(detail::read_gamete<
+                                                    gamete_t>(
+                                        f, gametes[d.second], keys,
+                                        nmutations));
+                                }
+                        }
+                    return rv;
+                }
+
+                template <typename poptype>
+                poptype
+                load() const
+                //! Read the entire population
+                {
+                    return detail::read_population<poptype>(f);
+                }
+            };
+        }
+    }
+}
+
+#endif
@@ -27,6 +27,8 @@
   moved over to fwdpp.
 */
 
+#include <cstddef>
+#include <cstdint>
 #include <type_traits>
 #include <vector>
 #include <algorithm>
@@ -34,22 +36,178 @@
 
 namespace fwdpy11
 {
+    class fixation_batch
+    /*!
+      Work space for update_mutations.
+
+      New fixations are collected during a call to update_mutations,
+      sorted by position, and merged into the fixation containers
+      once, rather than being inserted one at a time.
+
+      Fixed, selected mutations that are not removed from the
+      population are only searched for in the existing fixations
+      the first time that they are seen.  After that, their keys
+      are flagged as recorded until their counts return to zero,
+      which is when their keys may be recycled.
+
+      An instance should be kept for the duration of a call to an
+      evolve function.
+    */
+    {
+      private:
+        //! Keys of new fixations
+        std::vector<std::size_t> pending;
+        //! Keys of retained fixations seen for the first time
+        std::vector<std::size_t> unrecorded;
+        //! Non-zero for retained fixations that have been recorded
+        std::vector<std::uint8_t> recorded;
+
+      public:
+        fixation_batch() : pending{}, unrecorded{}, recorded{} {}
+
+        template <typename mcont_t>
+        inline void
+        check(const std::size_t i, const mcont_t &mutations,
+              std::vector<KTfwd::uint_t> &mcounts, const unsigned twoN,
+              const bool remove_selected_fixations)
+        //! Handle mutation i for update_mutations
+        {
+            assert(mcounts[i] <= twoN);
+            if (mcounts[i] == twoN)
+                {
+                    if (mutations[i].neutral
+                        || remove_selected_fixations == true)
+                        {
+                            pending.push_back(i);
+                            mcounts[i] = 0; // set count to zero to mark
+                                            // mutation as "recyclable"
+                        }
+                    else if (i >= recorded.size() || !recorded[i])
+                        {
+                            unrecorded.push_back(i);
+                        }
+                }
+            else if (!mcounts[i] && i < recorded.size())
+                {
+                    recorded[i] = 0;
+                }
+        }
+
+        template <typename mcont_t, typename fixation_container_t,
+                  typename fixation_time_container_t>
+        void
+        merge(const mcont_t &mutations, fixation_container_t &fixations,
+              fixation_time_container_t &fixation_times,
+              const unsigned generation)
+        /*!
+          Add the pending fixations to \a fixations and
+          \a fixation_times, keeping them sorted by position.
+          Retained fixations that are already present are skipped.
+        */
+        {
+            // A retained fixation may have been recorded before this
+            // object was created.  Only the existing fixations need to be
+            // searched, because new ones have unique positions.
+            for (auto i : unrecorded)
+                {
+                    auto loc = std::lower_bound(
+                        fixations.begin(), fixations.end(), mutations[i].pos,
+                        [](const typename fixation_container_t::value_type
+                               &__mut,
+                           const double &__value) noexcept {
+                            return __mut.pos < __value;
+                        });
+                    if (loc == fixations.end() || loc->pos != mutations[i].pos
+                        || loc->g != mutations[i].g)
+                        {
+                            pending.push_back(i);
+                        }
+                    if (i >= recorded.size())
+                        recorded.resize(i + 1, 0);
+                    recorded[i] = 1;
+                }
+            unrecorded.clear();
+            if (pending.empty())
+                return;
+            std::stable_sort(pending.begin(), pending.end(),
+                             [&mutations](const std::size_t a,
+                                          const std::size_t b) {
+                                 return mutations[a].pos < mutations[b].pos;
+                             });
+            // Append, then merge from the back.  A new fixation is
+            // placed before any existing one at the same position.
+            std::size_t i = fixations.size(), j = pending.size();
+            for (auto k : pending)
+                {
+                    fixations.push_back(mutations[k]);
+                    fixation_times.push_back(generation);
+                }
+            std::size_t out = fixations.size();
+            while (j > 0 && i > 0)
+                {
+                    const auto &m = mutations[pending[j - 1]];
+                    --out;
+                    if (!(fixations[i - 1].pos < m.pos))
+                        {
+                            --i;
+                            fixations[out] = std::move(fixations[i]);
+                            fixation_times[out] = fixation_times[i];
+                        }
+                    else
+                        {
+                            --j;
+                            fixations[out] = m;
+                            fixation_times[out] = generation;
+                        }
+                }
+            while (j > 0)
+                {
+                    --out;
+                    --j;
+                    fixations[out] = mutations[pending[j]];
+                    fixation_times[out] = generation;
+                }
+            pending.clear();
+        }
+    };
+
+    namespace detail
+    {
+        template <typename mcont_t, typename mutation_lookup_table>
+        inline void
+        update_mutation(const std::size_t i, const mcont_t &mutations,
+                        mutation_lookup_table &lookup,
+                        std::vector<KTfwd::uint_t> &mcounts,
+                        const unsigned &twoN,
+                        const bool remove_selected_fixations,
+                        fixation_batch &batch)
+        //! Handle mutation i for update_mutations
+        {
+            batch.check(i, mutations, mcounts, twoN,
+                        remove_selected_fixations);
+            if (!mcounts[i])
+                lookup.erase(mutations[i].pos);
+        }
+    }
+
     /// This function is similar in name and interface to the current fwdpp
     /// function in fwdpp/util.hpp. However, it accepts an additional bool
     /// to determine whether or not fixed, non-neutral mutations are flagged
     /// for recycling or not.
     ///
     /// It differs from the current fwdpp version in that:
-    /// 1. It uses std::lower_bound to make sure that fixations/fixation times
+    /// 1. It makes sure that fixations/fixation times
     /// are sorted by position
-    /// 2. It uses binary searches (again, lower_bound) to guard against
+    /// 2. It guards against
     /// re-inserting the same non-neutral fixation over and over.
     ///
     /// The reason for these changes is that the use case is sims of
     /// phenotypes.
     /// We keep fixations in the pop so that they contribute to trait values.
     /// Thus, w/o the
-    /// searches, we'd keep re-inserting a fixation each generation.
+    /// guard, we'd keep re-inserting a fixation each generation.
+    ///
+    /// New fixations are added via \a batch.  See fwdpy11::fixation_batch.
     ///
     /// \note: lookup must be compatible with
     /// lookup->erase(lookup->find(double))
@@ -62,7 +220,8 @@ namespace fwdpy11
                      mutation_lookup_table &lookup,
                      std::vector<KTfwd::uint_t> &mcounts,
                      const unsigned &generation, const unsigned &twoN,
-                     const bool remove_selected_fixations)
+                     const bool remove_selected_fixations,
+                     fixation_batch &batch)
     {
         using namespace KTfwd;
         static_assert(
@@ -72,47 +231,61 @@ namespace fwdpy11
         assert(mcounts.size() == mutations.size());
         for (unsigned i = 0; i < mcounts.size(); ++i)
             {
-                assert(mcounts[i] <= twoN);
-                if (mcounts[i] == twoN)
-                    {
-                        auto loc = std::lower_bound(
-                            fixations.begin(), fixations.end(),
-                            mutations[i].pos,
-                            [](const typename fixation_container_t::value_type
-                                   &__mut,
-                               const double &__value) noexcept {
-                                return __mut.pos < __value;
-                            });
-                        auto d = std::distance(fixations.begin(), loc);
-                        if (mutations[i].neutral
-                            || remove_selected_fixations == true)
-                            {
-                                fixations.insert(loc, mutations[i]);
-                                fixation_times.insert(
-                                    fixation_times.begin() + d, generation);
-                                mcounts[i] = 0; // set count to zero to mark
-                                                // mutation as "recyclable"
-                                lookup.erase(mutations[i].pos); // remove
-                                                                // mutation
-                                                                // position
-                                                                // from lookup
-                            }
-                        else
-                            {
-                                if (loc == fixations.end()
-                                    || (loc->pos != mutations[i].pos
-                                        && loc->g != mutations[i].g))
-                                    {
-                                        fixations.insert(loc, mutations[i]);
-                                        fixation_times.insert(
-                                            fixation_times.begin() + d,
-                                            generation);
-                                    }
-                            }
-                    }
-                if (!mcounts[i])
-                    lookup.erase(mutations[i].pos);
+                detail::update_mutation(i, mutations, lookup, mcounts, twoN,
+                                        remove_selected_fixations, batch);
+            }
+        batch.merge(mutations, fixations, fixation_times, generation);
+    }
+
+    /// Same as above, using a temporary fwdpy11::fixation_batch
+    template <typename mcont_t, typename fixation_container_t,
+              typename fixation_time_container_t,
+              typename mutation_lookup_table>
+    void
+    update_mutations(mcont_t &mutations, fixation_container_t &fixations,
+                     fixation_time_container_t &fixation_times,
+                     mutation_lookup_table &lookup,
+                     std::vector<KTfwd::uint_t> &mcounts,
+                     const unsigned &generation, const unsigned &twoN,
+                     const bool remove_selected_fixations)
+    {
+        fixation_batch batch;
+        update_mutations(mutations, fixations, fixation_times, lookup,
+                         mcounts, generation, twoN, remove_selected_fixations,
+                         batch);
+    }
+
+    /// Same as above, but only the mutations in \a keys are processed.
+    /// All other mutations must either have a count in (0, twoN),
+    /// have a count of zero and have been removed from \a lookup
+    /// already, or be retained fixations that were recorded in an
+    /// earlier generation.  See
+    /// fwdpy11::recycling_bins::changed_mutations.
+    template <typename mcont_t, typename fixation_container_t,
+              typename fixation_time_container_t,
+              typename mutation_lookup_table>
+    void
+    update_mutations(mcont_t &mutations, fixation_container_t &fixations,
+                     fixation_time_container_t &fixation_times,
+                     mutation_lookup_table &lookup,
+                     std::vector<KTfwd::uint_t> &mcounts,
+                     const unsigned &generation, const unsigned &twoN,
+                     const bool remove_selected_fixations,
+                     fixation_batch &batch,
+                     const std::vector<std::size_t> &keys)
+    {
+        using namespace KTfwd;
+        static_assert(
+            typename traits::is_mutation_t<
+                typename mcont_t::value_type>::type(),
+            "mutation_type must be derived from KTfwd::mutation_base");
+        assert(mcounts.size() == mutations.size());
+        for (auto i : keys)
+            {
+                detail::update_mutation(i, mutations, lookup, mcounts, twoN,
+                                        remove_selected_fixations, batch);
             }
+        batch.merge(mutations, fixations, fixation_times, generation);
     }
 
     //    struct update_mutations_wrapper
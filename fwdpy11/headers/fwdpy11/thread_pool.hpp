@@ -0,0 +1,176 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef FWDPY11_THREAD_POOL_HPP__
+#define FWDPY11_THREAD_POOL_HPP__
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace fwdpy11
+{
+    class thread_pool
+    /*!
+      A fixed-size set of worker threads that live for the duration of
+      a call to one of the evolve functions.
+
+      Work is submitted via run(), which calls f(i) for each thread
+      index i in [0, size()).  Index 0 is executed on the calling thread.
+      run() blocks until all workers are done.  The first exception
+      thrown by a worker is re-thrown on the calling thread.
+
+      The assignment of work to thread indexes is fixed, which is what
+      allows the threaded evolve functions to be reproducible for a
+      given seed and number of threads.
+    */
+    {
+      private:
+        std::vector<std::thread> workers;
+        std::vector<std::exception_ptr> errors;
+        std::function<void(unsigned)> job;
+        std::mutex m;
+        std::condition_variable start, finish;
+        unsigned long round;
+        unsigned pending;
+        bool stopping;
+
+        void
+        worker_loop(const unsigned index)
+        {
+            unsigned long seen = 0;
+            for (;;)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(m);
+                        start.wait(lock, [this, seen]() {
+                            return stopping || round != seen;
+                        });
+                        if (stopping)
+                            return;
+                        seen = round;
+                    }
+                    try
+                        {
+                            job(index);
+                        }
+                    catch (...)
+                        {
+                            errors[index] = std::current_exception();
+                        }
+                    std::lock_guard<std::mutex> lock(m);
+                    if (--pending == 0)
+                        finish.notify_one();
+                }
+        }
+
+      public:
+        explicit thread_pool(const unsigned nthreads)
+            : workers{}, errors(nthreads), job{}, m{}, start{}, finish{},
+              round(0), pending(0), stopping(false)
+        {
+            if (nthreads == 0)
+                {
+                    throw std::invalid_argument(
+                        "number of threads must be > 0");
+                }
+            for (unsigned i = 1; i < nthreads; ++i)
+                {
+                    workers.emplace_back(&thread_pool::worker_loop, this, i);
+                }
+        }
+
+        thread_pool(const thread_pool &) = delete;
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stopping = true;
+            }
+            start.notify_all();
+            for (auto &w : workers)
+                w.join();
+        }
+
+        inline unsigned
+        size() const
+        {
+            return static_cast<unsigned>(workers.size()) + 1;
+        }
+
+        template <typename F>
+        void
+        run(const F &f)
+        {
+            std::fill(errors.begin(), errors.end(), nullptr);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                job = std::cref(f);
+                pending = static_cast<unsigned>(workers.size());
+                ++round;
+            }
+            start.notify_all();
+            try
+                {
+                    f(0u);
+                }
+            catch (...)
+                {
+                    errors[0] = std::current_exception();
+                }
+            {
+                std::unique_lock<std::mutex> lock(m);
+                finish.wait(lock, [this]() { return pending == 0; });
+                job = nullptr;
+            }
+            for (auto &e : errors)
+                {
+                    if (e != nullptr)
+                        std::rethrow_exception(e);
+                }
+        }
+
+        template <typename F>
+        void
+        run_blocks(const std::size_t n, const F &f)
+        /*!
+          Split [0, n) into size() contiguous blocks and call
+          f(thread_index, begin, end) for each.  Block boundaries
+          depend only on n and size().
+        */
+        {
+            const unsigned nt = size();
+            run([n, nt, &f](const unsigned t) {
+                const std::size_t begin = (n * t) / nt;
+                const std::size_t end = (n * (t + 1)) / nt;
+                if (begin < end)
+                    f(t, begin, end);
+            });
+        }
+    };
+}
+
+#endif
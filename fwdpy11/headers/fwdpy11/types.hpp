@@ -27,7 +27,6 @@
 #include <fwdpy11/opaque/opaque_types.hpp>
 #include <fwdpy11/rng.hpp>
 #include <fwdpp/sugar.hpp>
-#include <fwdpp/sugar/GSLrng_t.hpp>
 #include <gsl/gsl_statistics_double.h>
 #include <map>
 #include <memory>
@@ -71,6 +70,60 @@ namespace fwdpy11
         }
     };
 
+    template <typename dipvector_t> struct offspring_buffer_t
+    /*!
+      Storage for the offspring generation.  The evolve functions
+      build the offspring here and then swap with the population's
+      diploids, so that the storage of the previous generation is
+      re-used and no container of diploids is allocated in a
+      generation unless the population grows.
+
+      Copies are empty, so that copying or assigning a population
+      does not copy this scratch space.
+    */
+    {
+        dipvector_t diploids;
+        offspring_buffer_t() : diploids{} {}
+        offspring_buffer_t(const offspring_buffer_t &) : diploids{} {}
+        offspring_buffer_t(offspring_buffer_t &&) : diploids{} {}
+        offspring_buffer_t &
+        operator=(const offspring_buffer_t &)
+        {
+            return *this;
+        }
+        offspring_buffer_t &
+        operator=(offspring_buffer_t &&)
+        {
+            return *this;
+        }
+
+        dipvector_t &
+        reset(const std::size_t N)
+        //! Return the storage, holding N default-constructed diploids.
+        {
+            diploids.assign(N, typename dipvector_t::value_type());
+            return diploids;
+        }
+
+        dipvector_t &
+        reset(const std::size_t N, const std::size_t nloci)
+        /*!
+          For multi-locus diploids: return the storage, holding N
+          diploids of nloci default-constructed loci each.
+          Existing diploids are re-used, so that the per-diploid
+          containers are only allocated when the population grows.
+        */
+        {
+            diploids.resize(N);
+            for (auto &dip : diploids)
+                {
+                    dip.assign(nloci,
+                               typename dipvector_t::value_type::value_type());
+                }
+            return diploids;
+        }
+    };
+
     struct singlepop_t : public KTfwd::singlepop<KTfwd::popgenmut, diploid_t>
     /*!
       \brief Single-deme object where mutations have single effect size and
@@ -114,8 +167,11 @@ namespace fwdpy11
         using base = KTfwd::singlepop<KTfwd::popgenmut, diploid_t>;
         //! The current generation.  Start counting from zero
         unsigned generation;
+        //! Re-used by the evolve functions
+        offspring_buffer_t<dipvector_t> offspring_buffer;
         //! Constructor takes number of diploids as argument
-        singlepop_t(const unsigned &N) : base(N), generation(0)
+        singlepop_t(const unsigned &N)
+            : base(N), generation(0), offspring_buffer{}
         {
             if (!N)
                 {
@@ -128,7 +184,10 @@ namespace fwdpy11
                 }
         }
 
-        singlepop_t(const std::string &s) : base(0) { this->deserialize(s); }
+        singlepop_t(const std::string &s) : base(0), offspring_buffer{}
+        {
+            this->deserialize(s);
+        }
 
         singlepop_t(singlepop_t &&) = default;
         singlepop_t(const singlepop_t &) = default;
@@ -150,22 +209,6 @@ namespace fwdpy11
                 s, KTfwd::mutation_reader<singlepop_t::mutation_t>(),
                 fwdpy11::diploid_reader(), 1);
         }
-
-        // int
-        // tofile(const char *filename, bool append = false) const
-        //{
-        //    return fwdpy11::serialization::gzserialize_details(
-        //        *this, KTfwd::mutation_writer(), fwdpy11::diploid_writer(),
-        //        filename, append);
-        //}
-
-        // void
-        // fromfile(const char *filename, std::size_t offset)
-        //{
-        //    *this = serialization::gzdeserialize_details<singlepop_t>()(
-        //        KTfwd::mutation_reader<singlepop_t::mutation_t>(),
-        //        fwdpy11::diploid_reader(), filename, offset, 0u);
-        //}
     };
 
     struct metapop_t : public KTfwd::metapop<KTfwd::popgenmut, diploid_t>
@@ -306,23 +349,6 @@ namespace fwdpy11
                 s, KTfwd::mutation_reader<singlepop_gm_vec_t::mutation_t>(),
                 fwdpy11::diploid_reader(), 1u);
         }
-
-        // int
-        // tofile(const char *filename, bool append = false) const
-        //{
-        //    return fwdpy11::serialization::gzserialize_details(
-        //        *this, KTfwd::mutation_writer(), fwdpy11::diploid_writer(),
-        //        filename, append);
-        //}
-
-        // void
-        // fromfile(const char *filename, std::size_t offset)
-        //{
-        //    *this = serialization::
-        //        gzdeserialize_details<singlepop_gm_vec_t>()(
-        //            KTfwd::mutation_reader<singlepop_gm_vec_t::mutation_t>(),
-        //            fwdpy11::diploid_reader(), filename, offset, 0u);
-        //}
     };
 
     // Types for multi-"locus" (multi-region) simulations
@@ -335,8 +361,12 @@ namespace fwdpy11
     {
         using base = KTfwd::multiloc<KTfwd::popgenmut, fwdpy11::diploid_t>;
         unsigned generation, nloci;
+        //! Re-used by the evolve functions
+        offspring_buffer_t<std::vector<multilocus_diploid_t>>
+            offspring_buffer;
         explicit multilocus_t(const unsigned N, const unsigned nloci_)
-            : base(N, nloci_), generation(0), nloci(nloci_)
+            : base(N, nloci_), generation(0), nloci(nloci_),
+              offspring_buffer{}
         {
             if (!N)
                 {
@@ -355,7 +385,8 @@ namespace fwdpy11
         explicit multilocus_t(
             const unsigned N, const unsigned nloci_,
             const std::vector<std::pair<double, double>> &locus_boundaries)
-            : base(N, nloci_, locus_boundaries), generation(0), nloci(nloci_)
+            : base(N, nloci_, locus_boundaries), generation(0), nloci(nloci_),
+              offspring_buffer{}
         {
             if (!N)
                 {
@@ -372,7 +403,8 @@ namespace fwdpy11
                 }
         }
 
-        explicit multilocus_t(const std::string &s) : base({ 0, 0 })
+        explicit multilocus_t(const std::string &s)
+            : base({ 0, 0 }), offspring_buffer{}
         {
             this->deserialize(s);
         }
@@ -396,22 +428,6 @@ namespace fwdpy11
                     this->nloci = this->diploids[0].size();
                 }
         }
-
-        // int
-        // tofile(const char *filename, bool append = false) const
-        //{
-        //    return fwdpy11::serialization::gzserialize_details(
-        //        *this, KTfwd::mutation_writer(), fwdpy11::diploid_writer(),
-        //        filename, append);
-        //}
-
-        // void
-        // fromfile(const char *filename, std::size_t offset)
-        //{
-        //    *this = serialization::gzdeserialize_details<multilocus_t>()(
-        //        KTfwd::mutation_reader<multilocus_t::mutation_t>(),
-        //        fwdpy11::diploid_reader(), filename, offset, 0u, 0u);
-        //}
     };
 }
 
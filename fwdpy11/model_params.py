@@ -61,6 +61,9 @@ class ModelParams(object):
     __recregions = None
     __demography = None
     __prune_selected = True
+    __nthreads = 1
+    __record_schedule = None
+    __update_schedule = None
 
     def __init__(self, **kwargs):
         for key, value in kwargs.items():
@@ -113,6 +116,79 @@ class ModelParams(object):
     def prune_selected(self, value):
         self.__prune_selected = bool(value)
 
+    @property
+    def nthreads(self):
+        """
+        Get or set the number of threads used each generation.
+
+        For single-locus simulations, threads are used to generate
+        offspring.  For multi-locus simulations, threads are used to
+        generate offspring if
+        :attr:`fwdpy11.model_params.MlocusParams.parallel_offspring`
+        is True.  For all simulations, threads are used to
+        calculate genetic values and fitnesses when the genetic
+        value functions are built-in types.  Python callbacks, such
+        as a trait-to-fitness mapping written in Python, are always
+        called from the main thread.
+
+        When setting, an int > 0 is required.  The default
+        is 1, which means that everything happens serially.
+
+        .. note::
+            For a given seed, results are reproducible for a
+            given number of threads.  Results obtained with
+            different numbers of threads differ from one another.
+
+        .. versionadded:: 0.1.3
+        """
+        return self.__nthreads
+
+    @nthreads.setter
+    def nthreads(self, value):
+        if isinstance(value, bool) or int(value) != value:
+            raise ValueError("nthreads must be an integer")
+        if value < 1:
+            raise ValueError("nthreads must be > 0")
+        self.__nthreads = int(value)
+
+    @property
+    def record_schedule(self):
+        """
+        Get or set the generations in which the recorder
+        is called.  See :ref:`schedules` for the allowed values.
+        The default is None, meaning every generation.
+
+        .. versionadded:: 0.1.3
+        """
+        return self.__record_schedule
+
+    @record_schedule.setter
+    def record_schedule(self, value):
+        self.__record_schedule = _validate_schedule(value)
+
+    @property
+    def update_schedule(self):
+        """
+        Get or set the generations in which the "update"
+        functions of trait-to-fitness mappings and noise functions
+        are called.  Only used by :func:`fwdpy11.wright_fisher_qtrait.evolve`.
+        See :ref:`schedules` for the allowed values.  The default
+        is None, meaning every generation.
+
+        .. note::
+            An update function that is not called in a generation
+            cannot respond to changes in that generation.  For
+            example, a change in optimum is delayed until the next
+            scheduled generation.
+
+        .. versionadded:: 0.1.3
+        """
+        return self.__update_schedule
+
+    @update_schedule.setter
+    def update_schedule(self, value):
+        self.__update_schedule = _validate_schedule(value)
+
     @nregions.setter
     def nregions(self, nregions):
         self.__nregions = nregions
@@ -157,6 +233,35 @@ class ModelParams(object):
             raise ValueError("demography cannot be None")
         if self.prune_selected is None:
             raise ValueError("prune_selected cannot be None")
+        if self.nthreads < 1:
+            raise ValueError("nthreads must be > 0")
+
+
+def _validate_schedule(value):
+    """
+    Returns value, with integer types converted to int.
+    """
+    import numpy as np
+    if value is None:
+        return value
+    if isinstance(value, np.ndarray) and value.dtype == np.bool_:
+        if value.ndim != 1:
+            raise ValueError("boolean schedule must be 1-dimensional")
+        return value
+    if isinstance(value, (bool, np.bool_)):
+        raise ValueError("invalid schedule: " + str(value))
+    if isinstance(value, (int, np.integer)):
+        if value < 1:
+            raise ValueError("schedule interval must be > 0")
+        return int(value)
+    try:
+        for i in value:
+            if int(i) != i or i < 0:
+                raise ValueError("generations in a schedule must be "
+                                 "non-negative integers")
+    except TypeError:
+        raise ValueError("invalid schedule: " + str(value))
+    return value
 
 
 def _validate_single_deme_demography(value):
@@ -204,6 +309,9 @@ class SlocusParams(ModelParams):
     __recrate = None
     __gvalue = None
     __pself = 0.0
+    __cache_gvalues = False
+    __deduplicate_gametes = False
+    __batch_random_draws = False
 
     def __init__(self, **kwargs):
         gv_present = False
@@ -350,6 +458,86 @@ class SlocusParams(ModelParams):
             raise ValueError("invalid genetic value type: " + str(type(f)))
         self.__gvalue = f
 
+    @property
+    def cache_gvalues(self):
+        """
+        Get or set whether genetic values are calculated using
+        a cache of per-gamete values.  When setting, a bool
+        is required.  The default is False.
+
+        Caching is only possible when gvalue is
+        :class:`fwdpy11.fitness.SlocusAdditive`,
+        :class:`fwdpy11.fitness.SlocusMult`,
+        :class:`fwdpy11.trait_values.SlocusAdditiveTrait`, or
+        :class:`fwdpy11.trait_values.SlocusMultTrait`.
+
+        .. note::
+            Values obtained with caching may differ
+            from those obtained without caching in the
+            last few decimal places.  The effect sizes
+            of mutations must not be changed by recorders or
+            other callbacks during a simulation.
+
+        .. versionadded:: 0.1.3
+        """
+        return self.__cache_gvalues
+
+    @cache_gvalues.setter
+    def cache_gvalues(self, value):
+        self.__cache_gvalues = bool(value)
+
+    @property
+    def deduplicate_gametes(self):
+        """
+        Get or set whether recombinant gametes that are
+        identical to gametes present in the parental or
+        offspring generation share a single gamete.  When
+        setting, a bool is required.  The default is False.
+
+        When True, no two gametes in the population contain
+        the same mutations, provided that this was true when
+        the simulation started.
+
+        De-duplication reduces the number of gametes stored in
+        the population, which is most useful when recombination
+        rates are high relative to mutation rates.  It does not
+        change the genotypes of offspring, but it does change
+        how offspring are generated, so that results differ from
+        those obtained without de-duplication for the same seed.
+
+        .. versionadded:: 0.1.3
+        """
+        return self.__deduplicate_gametes
+
+    @deduplicate_gametes.setter
+    def deduplicate_gametes(self, value):
+        self.__deduplicate_gametes = bool(value)
+
+    @property
+    def batch_random_draws(self):
+        """
+        Get or set whether the random numbers used for Mendelian
+        segregation, selfing, and the number of new mutations
+        per gamete are drawn in blocks at the start of each
+        generation.  When setting, a bool is required.  The
+        default is False.
+
+        Drawing in blocks avoids several calls into the GSL per
+        offspring, which is most useful for large populations.
+        Results are reproducible for a given seed, but differ
+        from those obtained without drawing in blocks.
+        When :attr:`fwdpy11.model_params.ModelParams.nthreads`
+        is greater than one, the number of new mutations is
+        still drawn by each thread.
+
+        .. versionadded:: 0.1.3
+        """
+        return self.__batch_random_draws
+
+    @batch_random_draws.setter
+    def batch_random_draws(self, value):
+        self.__batch_random_draws = bool(value)
+
     @ModelParams.demography.setter
     def demography(self, demog):
         _validate_single_deme_demography(demog)
@@ -405,6 +593,16 @@ class SlocusParams(ModelParams):
             raise ValueError("invalid genetic value type: " +
                              type(self.__gvalue_data['gvalue']))
 
+        if self.cache_gvalues is True:
+            from fwdpy11.fitness import SlocusAdditive, SlocusMult
+            from fwdpy11.trait_values import SlocusAdditiveTrait
+            from fwdpy11.trait_values import SlocusMultTrait
+            if isinstance(self.gvalue, (SlocusAdditive, SlocusMult,
+                                        SlocusAdditiveTrait,
+                                        SlocusMultTrait)) is False:
+                raise ValueError("cache_gvalues requires an additive "
+                                 "or multiplicative genetic value type")
+
         _validate_single_deme_demography(self.demography)
 
 
@@ -599,6 +797,7 @@ class MlocusParams(ModelParams):
     __gvalue = None
     __agg = None
     __pself = 0.0
+    __parallel_offspring = False
 
     def __init__(self, **kwargs):
         super(MlocusParams, self).__init__(**kwargs)
@@ -821,6 +1020,31 @@ class MlocusParams(ModelParams):
                 raise
         _validate_multilocus_rates(self.__mutrec_data)
 
+    @property
+    def parallel_offspring(self):
+        """
+        Get or set whether offspring are generated using
+        :attr:`fwdpy11.model_params.ModelParams.nthreads` threads.
+        When setting, a bool is required.  The default is False.
+
+        Parents, Mendelian segregation, and recombination between
+        loci are resolved first, on the main thread.  Then,
+        recombination within loci and the number of new mutations
+        at each locus are obtained for blocks of offspring in
+        parallel, with each thread using its own random number
+        stream.  This is most useful for models with many loci.
+
+        Results are reproducible for a given seed and number of
+        threads, but differ from those obtained when this is False.
+
+        .. versionadded:: 0.1.3
+        """
+        return self.__parallel_offspring
+
+    @parallel_offspring.setter
+    def parallel_offspring(self, value):
+        self.__parallel_offspring = bool(value)
+
     @property
     def interlocus(self):
         """
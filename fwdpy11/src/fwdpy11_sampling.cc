@@ -26,13 +26,17 @@
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 #include <pybind11/numpy.h>
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 #include <fwdpp/forward_types.hpp>
 #include <fwdpp/sugar/matrix.hpp>
 #include <fwdpp/sugar/sampling.hpp>
 #include <fwdpp/internal/IOhelp.hpp>
 #include <fwdpy11/types.hpp>
-#include <gsl/gsl_matrix_char.h>
+#include <fwdpy11/packed_matrix.hpp>
 namespace py = pybind11;
 
 static_assert(sizeof(char) == sizeof(std::int8_t),
@@ -44,29 +48,137 @@ matrix_to_sample(const std::vector<std::int8_t> &data,
 // returns a data structure compatible with libsequence/pylibseq iff
 // the data correspond to a haplotype matrix
 {
-    std::size_t ncol = data.size() / nrow;
-    const std::array<std::int8_t, 3> states{ '0', '1', '2' };
-    auto v = gsl_matrix_char_const_view_array(
-        reinterpret_cast<const char *>(data.data()), nrow, ncol);
+    const std::size_t ncol = data.size() / nrow;
+    const std::array<char, 3> states{ { '0', '1', '2' } };
+    std::vector<std::string> columns(ncol, std::string(nrow, '0'));
+    {
+        // The strings are filled row by row, which reads the
+        // (row-major) matrix in order.
+        py::gil_scoped_release release;
+        for (std::size_t j = 0; j < nrow; ++j)
+            {
+                const auto row = data.data() + j * ncol;
+                for (std::size_t i = 0; i < ncol; ++i)
+                    {
+                        columns[i][j] = states[row[i]];
+                    }
+            }
+    }
     py::list rv;
     for (std::size_t i = 0; i < ncol; ++i)
         {
-            auto c = gsl_matrix_char_const_column(&v.matrix, i);
-            std::string column_data;
-            for (std::size_t j = 0; j < c.vector.size; ++j)
-                {
-                    column_data.push_back(states[static_cast<std::int8_t>(
-                        gsl_vector_char_get(&c.vector, j))]);
-                }
-            if (column_data.size() != nrow)
-                {
-                    throw std::runtime_error("column_data.size() != nrow");
-                }
-            rv.append(py::make_tuple(pos[i], std::move(column_data)));
+            rv.append(py::make_tuple(pos[i], std::move(columns[i])));
         }
     return rv;
 }
 
+py::tuple
+matrix_to_sample_packed(const std::vector<std::int8_t> &data,
+                        const std::vector<double> &pos,
+                        const std::size_t nrow)
+// The (positions, genotypes) format of sample_separate_packed.
+// Each group of 8 rows is transposed into one byte per column.
+{
+    if (nrow == 0)
+        {
+            throw std::invalid_argument("matrix has no rows");
+        }
+    const std::size_t ncol = data.size() / nrow;
+    const std::size_t nbytes = (nrow + 7) / 8;
+    py::array_t<double> positions(ncol);
+    py::array_t<std::uint8_t> genotypes(
+        { ncol, nbytes },
+        { nbytes * sizeof(std::uint8_t), sizeof(std::uint8_t) });
+    auto pdata = positions.mutable_data();
+    auto gdata = genotypes.mutable_data();
+    bool haplotypes = true;
+    {
+        py::gil_scoped_release release;
+        std::copy(pos.begin(), pos.begin() + ncol, pdata);
+        for (std::size_t b = 0; b < nbytes; ++b)
+            {
+                const std::size_t first = 8 * b;
+                const std::size_t last = std::min(first + 8, nrow);
+                for (std::size_t i = 0; i < ncol; ++i)
+                    {
+                        unsigned byte = 0;
+                        for (std::size_t j = first; j < last; ++j)
+                            {
+                                const auto x = data[j * ncol + i];
+                                haplotypes = haplotypes && (x == 0 || x == 1);
+                                byte |= unsigned(x != 0) << (7 - (j - first));
+                            }
+                        gdata[i * nbytes + b]
+                            = static_cast<std::uint8_t>(byte);
+                    }
+            }
+    }
+    if (!haplotypes)
+        {
+            throw std::invalid_argument(
+                "matrix must be a haplotype matrix of 0 and 1");
+        }
+    return py::make_tuple(positions, genotypes);
+}
+
+class locus_lookup
+/*
+  Assign positions to loci via binary search over
+  locus boundaries sorted by start position.
+*/
+{
+  private:
+    std::vector<std::pair<double, double>> sorted;
+    std::vector<std::size_t> index;
+
+  public:
+    static constexpr std::size_t npos
+        = std::numeric_limits<std::size_t>::max();
+
+    explicit locus_lookup(
+        const std::vector<std::pair<double, double>> &boundaries)
+        : sorted{}, index(boundaries.size())
+    {
+        for (std::size_t i = 0; i < index.size(); ++i)
+            {
+                index[i] = i;
+            }
+        std::sort(index.begin(), index.end(),
+                  [&boundaries](const std::size_t a, const std::size_t b) {
+                      return boundaries[a].first < boundaries[b].first;
+                  });
+        for (auto i : index)
+            {
+                if (!sorted.empty()
+                    && boundaries[i].first < sorted.back().second)
+                    {
+                        throw std::invalid_argument(
+                            "locus boundaries must not overlap");
+                    }
+                sorted.push_back(boundaries[i]);
+            }
+    }
+
+    std::size_t
+    operator()(const double position) const
+    // Returns the index of the locus in the original
+    // boundaries, or npos if there is none.
+    {
+        auto itr = std::upper_bound(
+            sorted.begin(), sorted.end(), position,
+            [](const double p, const std::pair<double, double> &b) {
+                return p < b.first;
+            });
+        if (itr == sorted.begin() || !(position < (itr - 1)->second))
+            {
+                return npos;
+            }
+        return index[std::distance(sorted.begin(), itr) - 1];
+    }
+};
+
+constexpr std::size_t locus_lookup::npos;
+
 py::dict
 separate_samples_by_loci(
     const std::vector<std::pair<double, double>> &boundaries, py::list sample)
@@ -80,10 +192,8 @@ separate_samples_by_loci(
         {
             return rv;
         }
-    for (std::size_t i = 0; i < boundaries.size(); ++i)
-        {
-            rv[py::int_(i)] = py::list();
-        }
+    const locus_lookup lookup(boundaries);
+    std::vector<py::list> loci(boundaries.size());
     for (auto &&item : sample)
         {
             py::tuple site = py::reinterpret_borrow<py::tuple>(item);
@@ -93,25 +203,230 @@ separate_samples_by_loci(
                                              + std::to_string(site.size())
                                              + " seen when 2 was expected");
                 }
-            auto itr
-                = std::find_if(boundaries.begin(), boundaries.end(),
-                               [&site](const std::pair<double, double> &b) {
-                                   return site[0].cast<double>() >= b.first
-                                          && site[0].cast<double>() < b.second;
-                               });
-            if (itr == boundaries.end())
+            const auto position = site[0].cast<double>();
+            const auto d = lookup(position);
+            if (d == locus_lookup::npos)
                 {
                     throw std::runtime_error(
                         "could not find locus for mutation at position"
-                        + std::to_string(site[0].cast<double>()));
+                        + std::to_string(position));
                 }
-            auto d = std::distance(boundaries.begin(), itr);
-            py::list li = py::reinterpret_borrow<py::list>(rv[py::int_(d)]);
-            li.append(site);
+            loci[d].append(site);
+        }
+    for (std::size_t i = 0; i < loci.size(); ++i)
+        {
+            rv[py::int_(i)] = loci[i];
         }
     return rv;
 }
 
+py::array_t<std::int64_t>
+locus_indexes(const std::vector<std::pair<double, double>> &boundaries,
+              py::array_t<double, py::array::c_style | py::array::forcecast>
+                  positions)
+// NumPy in, NumPy out version of separate_samples_by_loci
+{
+    const locus_lookup lookup(boundaries);
+    const auto n = static_cast<std::size_t>(positions.size());
+    py::array_t<std::int64_t> rv(n);
+    const auto pdata = positions.data();
+    auto rdata = rv.mutable_data();
+    std::size_t missing = locus_lookup::npos;
+    {
+        py::gil_scoped_release release;
+        for (std::size_t i = 0; i < n; ++i)
+            {
+                const auto d = lookup(pdata[i]);
+                if (d == locus_lookup::npos && missing == locus_lookup::npos)
+                    {
+                        missing = i;
+                    }
+                rdata[i] = static_cast<std::int64_t>(d);
+            }
+    }
+    if (missing != locus_lookup::npos)
+        {
+            throw std::runtime_error(
+                "could not find locus for mutation at position"
+                + std::to_string(pdata[missing]));
+        }
+    return rv;
+}
+
+namespace
+{
+    struct packed_partition
+    /*
+      The sites in one partition (neutral or selected) of a sample.
+      Each site is a row of bits, one per sampled chromosome,
+      packed eight to a byte with the first chromosome in the
+      most significant bit.  Rows are stored in the order in which
+      their mutations are first seen.
+    */
+    {
+        const std::size_t nchrom, nbytes;
+        std::vector<double> positions;
+        std::vector<std::size_t> counts;
+        std::vector<std::uint8_t> bits;
+
+        explicit packed_partition(const std::size_t nchrom_)
+            : nchrom(nchrom_), nbytes((nchrom + 7) / 8), positions{},
+              counts{}, bits{}
+        {
+        }
+
+        template <typename mcont_t>
+        void
+        add(const std::vector<KTfwd::uint_t> &gamete_keys,
+            const std::size_t chrom, const mcont_t &mutations,
+            std::vector<std::size_t> &row)
+        {
+            const auto mask
+                = static_cast<std::uint8_t>(0x80u >> (chrom % 8));
+            for (auto k : gamete_keys)
+                {
+                    if (row[k] == std::numeric_limits<std::size_t>::max())
+                        {
+                            row[k] = positions.size();
+                            positions.push_back(mutations[k].pos);
+                            counts.push_back(0);
+                            bits.resize(bits.size() + nbytes, 0);
+                        }
+                    bits[row[k] * nbytes + chrom / 8] |= mask;
+                    ++counts[row[k]];
+                }
+        }
+
+        template <typename mcont_t>
+        void
+        add_fixations(const mcont_t &fixations, const bool neutral)
+        /*
+          As fwdpp's sampling functions do, add each fixation in the
+          partition as a site where all chromosomes carry the derived
+          state, unless the sample already contains a site at that
+          position.
+        */
+        {
+            std::vector<double> seen(positions);
+            std::sort(seen.begin(), seen.end());
+            for (const auto &f : fixations)
+                {
+                    if (f.neutral != neutral
+                        || std::binary_search(seen.begin(), seen.end(),
+                                              f.pos))
+                        {
+                            continue;
+                        }
+                    positions.push_back(f.pos);
+                    counts.push_back(nchrom);
+                    const auto offset = bits.size();
+                    bits.resize(offset + nbytes, 0xff);
+                    if (nchrom % 8 != 0)
+                        {
+                            // Unused bits are zero
+                            bits.back() = static_cast<std::uint8_t>(
+                                0xffu << (8 - nchrom % 8));
+                        }
+                }
+        }
+
+        py::tuple
+        to_arrays(const bool removeFixed) const
+        // Returns (positions, bits), sorted by position
+        {
+            std::vector<std::size_t> order;
+            order.reserve(positions.size());
+            for (std::size_t i = 0; i < positions.size(); ++i)
+                {
+                    if (!removeFixed || counts[i] < nchrom)
+                        order.push_back(i);
+                }
+            std::sort(order.begin(), order.end(),
+                      [this](const std::size_t a, const std::size_t b) {
+                          return positions[a] < positions[b];
+                      });
+            py::array_t<double> pos(order.size());
+            py::array_t<std::uint8_t> matrix(
+                { order.size(), nbytes },
+                { nbytes * sizeof(std::uint8_t), sizeof(std::uint8_t) });
+            auto pos_data = pos.mutable_data();
+            auto matrix_data = matrix.mutable_data();
+            for (std::size_t i = 0; i < order.size(); ++i)
+                {
+                    pos_data[i] = positions[order[i]];
+                    std::copy(bits.begin() + order[i] * nbytes,
+                              bits.begin() + (order[i] + 1) * nbytes,
+                              matrix_data + i * nbytes);
+                }
+            return py::make_tuple(pos, matrix);
+        }
+    };
+
+    template <typename poptype>
+    py::tuple
+    sample_separate_packed(const poptype &pop,
+                           const std::vector<std::size_t> &individuals,
+                           const bool removeFixed)
+    /*
+      Equivalent to KTfwd::sample_separate, but the sample is returned
+      as NumPy arrays built in a single pass over the sampled gametes,
+      rather than as lists of (position, string) tuples.
+    */
+    {
+        fwdpy11::validate_individuals(pop, individuals);
+        const std::size_t nchrom = 2 * individuals.size();
+        // Row of each mutation in its partition.
+        // Neutral and selected keys never overlap.
+        std::vector<std::size_t> row(
+            pop.mutations.size(), std::numeric_limits<std::size_t>::max());
+        packed_partition neutral(nchrom), selected(nchrom);
+        fwdpy11::visit_sampled_gametes(
+            pop, individuals,
+            [&](const fwdpy11::gamete_t &g, const std::size_t c) {
+                neutral.add(g.mutations, c, pop.mutations, row);
+                selected.add(g.smutations, c, pop.mutations, row);
+            });
+        if (!removeFixed)
+            {
+                neutral.add_fixations(pop.fixations, true);
+                selected.add_fixations(pop.fixations, false);
+            }
+        return py::make_tuple(neutral.to_arrays(removeFixed),
+                              selected.to_arrays(removeFixed));
+    }
+
+    template <typename poptype>
+    py::tuple
+    sample_separate_packed(const fwdpy11::GSLrng_t &rng, const poptype &pop,
+                           const KTfwd::uint_t samplesize,
+                           const bool removeFixed)
+    // Samples samplesize/2 diploids with replacement.
+    {
+        if (samplesize == 0 || samplesize % 2 != 0)
+            {
+                throw std::invalid_argument(
+                    "sample size must be a positive, even number");
+            }
+        std::vector<std::size_t> individuals(samplesize / 2);
+        for (auto &i : individuals)
+            {
+                i = gsl_rng_uniform_int(rng.get(), pop.diploids.size());
+            }
+        return sample_separate_packed(pop, individuals, removeFixed);
+    }
+}
+
+py::array_t<std::uint64_t>
+packed_words(const fwdpy11::packed_bit_matrix &bits, py::object base)
+// A view of the words of bits, with one row per line.
+{
+    const auto wpl = bits.words_per_line();
+    return py::array_t<std::uint64_t>(
+        { bits.nlines(), wpl },
+        { wpl * sizeof(std::uint64_t), sizeof(std::uint64_t) },
+        bits.words.data(), base);
+}
+
 PYBIND11_MAKE_OPAQUE(std::vector<std::int8_t>);
 
 PYBIND11_PLUGIN(sampling)
@@ -168,6 +483,66 @@ PYBIND11_PLUGIN(sampling)
     SAMPLE_SEPARATE_IND(fwdpy11::singlepop_gm_vec_t,
                         "fwdpy11.fwdpy11_types.SlocusPopGeneralMutVec")
 
+#define SAMPLE_SEPARATE_PACKED_DOC(CLASSTYPE)                                 \
+    ":param pop: A :class:`" CLASSTYPE "`\n"                                  \
+    ":param removeFixed: (boolean, defaults to True) Whether or not to "      \
+    "include fixations.\n"                                                    \
+    ":rtype: tuple\n\n"                                                       \
+    ":return: A tuple.  The first element contains neutral variants, "        \
+    "and the second contains selected variants.  Each is a tuple of "         \
+    "(positions, genotypes).  Positions are a 1d array of float, in "         \
+    "increasing order.  Genotypes are a 2d array of dtype numpy.uint8, with " \
+    "one row per site.  Each row contains one bit per sampled chromosome, "   \
+    "packed with the first chromosome in the most significant bit, as done "  \
+    "by numpy.packbits.  Thus, numpy.unpackbits(genotypes, axis=1)[:, :n] "   \
+    "is a 0/1 matrix containing the same data as the strings returned by "    \
+    ":func:`fwdpy11.sampling.sample_separate`.\n\n"                           \
+    ".. versionadded:: 0.1.3\n"
+
+#define SAMPLE_SEPARATE_PACKED_RANDOM(POPTYPE, CLASSTYPE)                     \
+    m.def("sample_separate_packed",                                           \
+          [](const fwdpy11::GSLrng_t &rng, const POPTYPE &pop,                \
+             const KTfwd::uint_t samplesize, const bool removeFixed) {        \
+              return sample_separate_packed(rng, pop, samplesize,             \
+                                            removeFixed);                     \
+          },                                                                  \
+          "Take a sample of :math:`n` chromosomes (:math:`n/2` diploids, "    \
+          "sampled with replacement) from a population, returning NumPy "     \
+          "arrays.\n\n"                                                       \
+          ":param rng: A :class:`fwdpy11.fwdpy11_types.GSLrng`\n"             \
+          ":param samplesize: (int) The sample size, which must be even.\n"   \
+          SAMPLE_SEPARATE_PACKED_DOC(CLASSTYPE),                              \
+          py::arg("rng"), py::arg("pop"), py::arg("samplesize"),              \
+          py::arg("removeFixed") = true);
+
+#define SAMPLE_SEPARATE_PACKED_IND(POPTYPE, CLASSTYPE)                        \
+    m.def("sample_separate_packed",                                           \
+          [](const POPTYPE &pop, const std::vector<std::size_t> &individuals, \
+             const bool removeFixed) {                                        \
+              return sample_separate_packed(pop, individuals, removeFixed);   \
+          },                                                                  \
+          "Take a sample of specific individuals from a population, "         \
+          "returning NumPy arrays.\n\n"                                       \
+          ":param individuals : (list of int) Indexes of individuals.  "      \
+          "Chromosomes 2i and 2i+1 of the sample come from individuals[i].\n" \
+          SAMPLE_SEPARATE_PACKED_DOC(CLASSTYPE),                              \
+          py::arg("pop"), py::arg("individuals"),                             \
+          py::arg("removeFixed") = true);
+
+    SAMPLE_SEPARATE_PACKED_RANDOM(fwdpy11::singlepop_t,
+                                  "fwdpy11.fwdpy11_types.SlocusPop")
+    SAMPLE_SEPARATE_PACKED_RANDOM(fwdpy11::multilocus_t,
+                                  "fwdpy11.fwdpy11_types.MlocusPop")
+    SAMPLE_SEPARATE_PACKED_RANDOM(
+        fwdpy11::singlepop_gm_vec_t,
+        "fwdpy11.fwdpy11_types.SlocusPopGeneralMutVec")
+    SAMPLE_SEPARATE_PACKED_IND(fwdpy11::singlepop_t,
+                               "fwdpy11.fwdpy11_types.SlocusPop")
+    SAMPLE_SEPARATE_PACKED_IND(fwdpy11::multilocus_t,
+                               "fwdpy11.fwdpy11_types.MlocusPop")
+    SAMPLE_SEPARATE_PACKED_IND(fwdpy11::singlepop_gm_vec_t,
+                               "fwdpy11.fwdpy11_types.SlocusPopGeneralMutVec")
+
     py::bind_vector<std::vector<std::int8_t>>(m, "Vec8",
                                               py::buffer_protocol());
 
@@ -306,6 +681,114 @@ PYBIND11_PLUGIN(sampling)
                 }
         });
 
+    py::class_<fwdpy11::packed_haplotype_matrix>(m, "PackedHaplotypeMatrix",
+                                                 R"delim(
+        A haplotype matrix with one bit per cell, stored in 64-bit words.
+
+        There are two rows per sampled diploid, and one column per
+        mutation key, as for :class:`fwdpy11.sampling.DataMatrix`
+        encoded as a haplotype matrix.  The matrices may be stored
+        row-major, with the bits of each row in consecutive words,
+        or column-major, with the bits of each site in consecutive
+        words.  Within a word, the first cell is the least significant
+        bit.  The last word of each row (or column) is padded with zeros.
+
+        You do not create objects of this type directly.  Instead, use
+        :func:`fwdpy11.sampling.packed_haplotype_matrix`.
+
+        .. versionadded:: 0.1.3
+        )delim")
+        .def_property_readonly(
+            "row_major",
+            [](const fwdpy11::packed_haplotype_matrix &pm) {
+                return pm.neutral.row_major;
+            },
+            "True if the bits of each row are stored in consecutive "
+            "words, and False if the bits of each column are.")
+        .def_property_readonly(
+            "neutral",
+            [](py::object self) {
+                const auto &pm
+                    = self.cast<const fwdpy11::packed_haplotype_matrix &>();
+                return packed_words(pm.neutral, self);
+            },
+            "The words representing neutral variants, as a 2d numpy "
+            "array of dtype numpy.uint64 with one row per line of the "
+            "matrix.  The data are not copied.")
+        .def_property_readonly(
+            "selected",
+            [](py::object self) {
+                const auto &pm
+                    = self.cast<const fwdpy11::packed_haplotype_matrix &>();
+                return packed_words(pm.selected, self);
+            },
+            "The words representing selected variants, as a 2d numpy "
+            "array of dtype numpy.uint64 with one row per line of the "
+            "matrix.  The data are not copied.")
+        .def_readonly("neutral_positions",
+                      &fwdpy11::packed_haplotype_matrix::neutral_positions,
+                      "The list of neutral mutation positions.")
+        .def_readonly("selected_positions",
+                      &fwdpy11::packed_haplotype_matrix::selected_positions,
+                      "The list of selected mutation positions.")
+        .def_readonly(
+            "neutral_popfreq",
+            &fwdpy11::packed_haplotype_matrix::neutral_popfreq,
+            "The list of population frequencies of neutral mutations.")
+        .def_readonly(
+            "selected_popfreq",
+            &fwdpy11::packed_haplotype_matrix::selected_popfreq,
+            "The list of population frequencies of selected mutations.")
+        .def("ndim_neutral",
+             [](const fwdpy11::packed_haplotype_matrix &pm) {
+                 return py::make_tuple(pm.neutral.nrow, pm.neutral.ncol);
+             },
+             "Return the dimensions of the neutral matrix, in cells.\n\n"
+             ":rtype: tuple\n")
+        .def("ndim_selected",
+             [](const fwdpy11::packed_haplotype_matrix &pm) {
+                 return py::make_tuple(pm.selected.nrow, pm.selected.ncol);
+             },
+             "Return the dimensions of the selected matrix, in cells.\n\n"
+             ":rtype: tuple\n")
+        .def("unpack",
+             [](const fwdpy11::packed_haplotype_matrix &pm,
+                const bool neutral) {
+                 const auto &bits = neutral ? pm.neutral : pm.selected;
+                 py::array_t<std::int8_t> rv(
+                     { bits.nrow, bits.ncol },
+                     { bits.ncol * sizeof(std::int8_t),
+                       sizeof(std::int8_t) });
+                 auto out = rv.mutable_data();
+                 {
+                     py::gil_scoped_release release;
+                     bits.unpack(out);
+                 }
+                 return rv;
+             },
+             R"delim(
+             Return the neutral or selected matrix with one byte
+             per cell, as a 2d numpy array of dtype numpy.int8.
+
+             :param neutral: (True) Return neutral or selected data.
+             )delim",
+             py::arg("neutral") = true)
+        .def("to_DataMatrix",
+             [](const fwdpy11::packed_haplotype_matrix &pm) {
+                 KTfwd::data_matrix rv(pm.neutral.nrow);
+                 rv.neutral.resize(pm.neutral.nrow * pm.neutral.ncol);
+                 rv.selected.resize(pm.selected.nrow * pm.selected.ncol);
+                 pm.neutral.unpack(rv.neutral.data());
+                 pm.selected.unpack(rv.selected.data());
+                 rv.neutral_positions = pm.neutral_positions;
+                 rv.selected_positions = pm.selected_positions;
+                 rv.neutral_popfreq = pm.neutral_popfreq;
+                 rv.selected_popfreq = pm.selected_popfreq;
+                 return rv;
+             },
+             "Convert to a :class:`fwdpy11.sampling.DataMatrix` "
+             "encoded as a haplotype matrix.");
+
 #define MUTATION_KEYS(POPTYPE, CLASSTYPE)                                     \
     m.def("mutation_keys",                                                    \
           [](const POPTYPE &pop, const std::vector<std::size_t> &individuals, \
@@ -362,6 +845,29 @@ PYBIND11_PLUGIN(sampling)
           ":rtype: :class:`fwdpy11.sampling.DataMatrix` encoded as a "        \
           "haplotype matrix\n");
 
+#define PACKED_HAPLOTYPE_MATRIX(POPTYPE, CLASSTYPE)                           \
+    m.def("packed_haplotype_matrix",                                          \
+          [](const POPTYPE &pop, const std::vector<std::size_t> &individuals, \
+             const keytype &neutral_keys, const keytype &selected_keys,       \
+             const bool row_major) {                                          \
+              return fwdpy11::make_packed_haplotype_matrix(                   \
+                  pop, individuals, neutral_keys, selected_keys, row_major);  \
+          },                                                                  \
+          "Generate a :class:`fwdpy11.sampling.PackedHaplotypeMatrix` from "  \
+          "a :class:`" CLASSTYPE "` object.\n\n"                              \
+          ":param pop: A population object.\n"                                \
+          ":param individuals: A list of indexes to diploids.\n"              \
+          ":param neutral_keys: The return value from "                       \
+          ":func:`fwdpy11.sampling.mutation_keys`.\n"                         \
+          ":param selected_keys: The return value from "                      \
+          ":func:`fwdpy11.sampling.mutation_keys`.\n"                         \
+          ":param row_major: (True) Whether the bits of each row, or of "     \
+          "each column, are stored in consecutive words.\n\n"                \
+          ":rtype: :class:`fwdpy11.sampling.PackedHaplotypeMatrix`\n\n"      \
+          ".. versionadded:: 0.1.3\n",                                        \
+          py::arg("pop"), py::arg("individuals"), py::arg("neutral_keys"),    \
+          py::arg("selected_keys"), py::arg("row_major") = true);
+
     MUTATION_KEYS(fwdpy11::singlepop_t, "fwdpy11.fwdpy11_types.SlocusPop");
     MUTATION_KEYS(fwdpy11::multilocus_t, "fwdpy11.fwdpy11_types.MlocusPop");
     MUTATION_KEYS(fwdpy11::singlepop_gm_vec_t,
@@ -377,6 +883,13 @@ PYBIND11_PLUGIN(sampling)
     HAPLOTYPE_MATRIX(fwdpy11::singlepop_gm_vec_t,
                      "fwdpy11.fwdpy11_types.SlocusPopGeneralMutVec");
 
+    PACKED_HAPLOTYPE_MATRIX(fwdpy11::singlepop_t,
+                            "fwdpy11.fwdpy11_types.SlocusPop");
+    PACKED_HAPLOTYPE_MATRIX(fwdpy11::multilocus_t,
+                            "fwdpy11.fwdpy11_types.MlocusPop");
+    PACKED_HAPLOTYPE_MATRIX(fwdpy11::singlepop_gm_vec_t,
+                            "fwdpy11.fwdpy11_types.SlocusPopGeneralMutVec");
+
     m.def("matrix_to_sample",
           [](const KTfwd::data_matrix &m, const bool neutral)
 
@@ -413,6 +926,34 @@ PYBIND11_PLUGIN(sampling)
           )delim",
           py::arg("m"), py::arg("neutral") = true);
 
+    m.def("matrix_to_sample_packed",
+          [](const KTfwd::data_matrix &m, const bool neutral) {
+              return (neutral) ? matrix_to_sample_packed(
+                                     m.neutral, m.neutral_positions, m.nrow)
+                               : matrix_to_sample_packed(m.selected,
+                                                         m.selected_positions,
+                                                         m.nrow);
+          },
+          R"delim(
+          Convert a :class:`fwdpy11.sampling.DataMatrix` encoded
+          as a haplotype matrix into NumPy arrays.
+
+          .. versionadded:: 0.1.3
+
+          :param m: A :class:`fwdpy11.sampling.DataMatrix`
+          :param neutral: (True) Return data for neutral or selected sites.
+
+          :rtype: tuple
+
+          :return: A tuple of (positions, genotypes), in the format
+              returned by :func:`fwdpy11.sampling.sample_separate_packed`.
+              Row i of genotypes is column i of the original matrix,
+              with one bit per row of the original matrix.
+
+          :raises: ValueError if the matrix contains values other than 0 or 1.
+          )delim",
+          py::arg("m"), py::arg("neutral") = true);
+
     m.def("separate_samples_by_loci", &separate_samples_by_loci,
           R"delim(
             Convert the output from :func:`fwdpy11.sampling.matrix_to_sample` into 
@@ -434,5 +975,26 @@ PYBIND11_PLUGIN(sampling)
 				The key for each entry in the dict is the locus index.
             )delim");
 
+    m.def("locus_indexes", &locus_indexes,
+          R"delim(
+          Find the locus containing each of a set of positions.
+
+          .. versionadded:: 0.1.3
+
+          :param boundaries: A list of [start,stop) tuples representing
+              positions, such as :attr:`fwdpy11.MlocusPop.locus_boundaries`.
+          :param positions: A 1d array of positions.
+
+          :rtype: numpy.ndarray
+
+          :return: The index of the locus containing each position.
+              Thus, positions[locus_indexes(boundaries, positions) == i]
+              are the positions in locus i.
+
+          :raises: ValueError if boundaries overlap, and RuntimeError if
+              a position is not contained in any locus.
+          )delim",
+          py::arg("boundaries"), py::arg("positions"));
+
     return m.ptr();
 }
@@ -1,70 +1,13 @@
 #include <fwdpy11/types.hpp>
 #include <fwdpy11/fitness/fitness.hpp>
+#include <fwdpy11/fitness/trait_values.hpp>
 #include <pybind11/pybind11.h>
-#include <numeric>
-#include <cmath>
 
 namespace py = pybind11;
 
-struct additive_diploid_trait_fxn
-{
-    const KTfwd::additive_diploid w;
-    additive_diploid_trait_fxn()
-        : w{ KTfwd::additive_diploid(KTfwd::atrait()) }
-    {
-    }
-    inline double
-    operator()(const fwdpy11::diploid_t &dip, const fwdpy11::gcont_t &gametes,
-               const fwdpy11::mcont_t &mutations, const double scaling) const
-    {
-        return w(dip, gametes, mutations, scaling);
-    }
-};
-
-struct multiplicative_diploid_trait_fxn
-{
-    const KTfwd::multiplicative_diploid w;
-    multiplicative_diploid_trait_fxn()
-        : w{ KTfwd::multiplicative_diploid(KTfwd::mtrait()) }
-    {
-    }
-    inline double
-    operator()(const fwdpy11::diploid_t &dip, const fwdpy11::gcont_t &gametes,
-               const fwdpy11::mcont_t &mutations, const double scaling) const
-    {
-        return w(dip, gametes, mutations, scaling);
-    }
-};
-
-struct gbr_diploid_trait_fxn
-{
-    inline double
-    operator()(const fwdpy11::diploid_t &dip, const fwdpy11::gcont_t &gametes,
-               const fwdpy11::mcont_t &mutations, const double) const
-    {
-        auto sum1 = std::accumulate(
-            gametes[dip.first].smutations.cbegin(),
-            gametes[dip.first].smutations.cend(), 0.,
-            [&mutations](const double s, const KTfwd::uint_t key) {
-                return s + mutations[key].s;
-            });
-        auto sum2 = std::accumulate(
-            gametes[dip.second].smutations.cbegin(),
-            gametes[dip.second].smutations.cend(), 0.,
-            [&mutations](const double s, const KTfwd::uint_t key) {
-                return s + mutations[key].s;
-            });
-        return std::sqrt(sum1 * sum2);
-    }
-};
-
-using single_locus_multiplicative_trait_wrapper
-    = fwdpy11::fwdpp_single_locus_fitness_wrapper<
-        multiplicative_diploid_trait_fxn>;
-using single_locus_additive_trait_wrapper
-    = fwdpy11::fwdpp_single_locus_fitness_wrapper<additive_diploid_trait_fxn>;
-using gbr_trait_wrapper
-    = fwdpy11::fwdpp_single_locus_fitness_wrapper<gbr_diploid_trait_fxn>;
+using fwdpy11::single_locus_additive_trait_wrapper;
+using fwdpy11::single_locus_multiplicative_trait_wrapper;
+using fwdpy11::gbr_trait_wrapper;
 
 PYBIND11_PLUGIN(trait_values)
 {
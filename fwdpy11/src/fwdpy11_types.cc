@@ -16,6 +16,7 @@
 // You should have received a copy of the GNU General Public License
 // along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
 //
+#include <numeric>
 #include <pybind11/functional.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
@@ -23,6 +24,8 @@
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 #include <fwdpy11/types.hpp>
+#include <fwdpy11/serialization/binary_file.hpp>
+#include <fwdpy11/serialization/file_reader.hpp>
 
 namespace py = pybind11;
 
@@ -94,6 +97,81 @@ PYBIND11_MAKE_OPAQUE(std::vector<flattened_popgenmut>);
 PYBIND11_MAKE_OPAQUE(std::vector<diploid_traits>);
 PYBIND11_MAKE_OPAQUE(std::vector<diploid_gametes>);
 
+namespace
+{
+    // Zero-copy views of containers.  Neither diploid_t nor
+    // KTfwd::popgenmut is a standard-layout type, so the offsets
+    // of their fields are obtained from an instance.
+
+    template <typename T, typename F>
+    inline void
+    add_view_field(py::list& names, py::list& formats, py::list& offsets,
+                   const char* name, const T& t, const F& field)
+    {
+        names.append(py::str(name));
+        formats.append(py::str(py::format_descriptor<F>::format()));
+        offsets.append(
+            py::int_(static_cast<std::size_t>(
+                reinterpret_cast<const char*>(&field)
+                - reinterpret_cast<const char*>(&t))));
+    }
+
+    py::dtype
+    diploid_view_dtype()
+    {
+        const fwdpy11::diploid_t d;
+        py::list names, formats, offsets;
+        add_view_field(names, formats, offsets, "first", d, d.first);
+        add_view_field(names, formats, offsets, "second", d, d.second);
+        add_view_field(names, formats, offsets, "label", d, d.label);
+        add_view_field(names, formats, offsets, "g", d, d.g);
+        add_view_field(names, formats, offsets, "e", d, d.e);
+        add_view_field(names, formats, offsets, "w", d, d.w);
+        return py::dtype(names, formats, offsets,
+                         sizeof(fwdpy11::diploid_t));
+    }
+
+    py::dtype
+    mutation_view_dtype()
+    {
+        const KTfwd::popgenmut m(0., 0., 0., 0, 0);
+        py::list names, formats, offsets;
+        add_view_field(names, formats, offsets, "pos", m, m.pos);
+        add_view_field(names, formats, offsets, "s", m, m.s);
+        add_view_field(names, formats, offsets, "h", m, m.h);
+        add_view_field(names, formats, offsets, "g", m, m.g);
+        add_view_field(names, formats, offsets, "label", m, m.xtra);
+        add_view_field(names, formats, offsets, "neutral", m, m.neutral);
+        return py::dtype(names, formats, offsets, sizeof(KTfwd::popgenmut));
+    }
+
+    py::array
+    make_readonly_view(const py::dtype& dtype, const void* data,
+                       const std::size_t n, const std::size_t stride,
+                       py::handle base)
+    /*
+     * A read-only 1d array of n records stride bytes apart.
+     * The array does not own the data, and keeps base alive.
+     */
+    {
+        py::array rv(dtype, { n }, { stride }, n ? data : nullptr, base);
+        rv.attr("setflags")(py::arg("write") = false);
+        return rv;
+    }
+
+    static const auto VIEW_DOCSTRING = R"delim(
+    Return a read-only, structured Numpy array that refers
+    directly to the C++ data, without copying them.
+
+    The array keeps the population alive.  However, it becomes
+    invalid if the container changes size, e.g., when the
+    population is evolved.  Do not keep views across calls
+    to evolve functions.
+
+    .. versionadded:: 0.1.3
+    )delim";
+}
+
 namespace
 {
     static const auto MCOUNTS_DOCSTRING = R"delim(
@@ -127,6 +205,126 @@ namespace
         To distinguish them, use the locations of nonzero values in "mcounts" 
         for an instance of this type."
     )delim";
+
+    static const auto TOFILE_DOCSTRING = R"delim(
+    Write the population to a binary file.
+
+    :param filename: The file name.  An existing file is overwritten.
+
+    The data are written directly to the file, without first
+    making a copy of the population in memory, which is what
+    pickling does.  See :ref:`binary_files`.
+
+    .. versionadded:: 0.1.3
+    )delim";
+
+    static const auto FROMFILE_DOCSTRING = R"delim(
+    Read a population from a file written by tofile.
+
+    :param filename: The file name.
+
+    :rtype: A new population object
+
+    :raises ValueError: if the file is not valid, or contains a
+        different type of population.
+
+    .. versionadded:: 0.1.3
+    )delim";
+
+    template <typename poptype, typename pyclass>
+    void
+    add_file_io(pyclass& c)
+    {
+        c.def("tofile",
+              [](const poptype& pop, const std::string& filename) {
+                  py::gil_scoped_release release;
+                  fwdpy11::serialization::binary::tofile(pop,
+                                                         filename.c_str());
+              },
+              py::arg("filename"), TOFILE_DOCSTRING)
+            .def_static("fromfile",
+                        [](const std::string& filename) {
+                            py::gil_scoped_release release;
+                            return fwdpy11::serialization::binary::fromfile<
+                                poptype>(filename.c_str());
+                        },
+                        py::arg("filename"), FROMFILE_DOCSTRING);
+    }
+
+    using fwdpy11::serialization::binary::population_file_reader;
+    using fwdpy11::serialization::binary::population_type;
+
+    template <typename F>
+    inline auto
+    without_gil(const F& f) -> decltype(f())
+    {
+        py::gil_scoped_release release;
+        return f();
+    }
+
+    inline bool
+    is_poptype(const population_file_reader& r, const population_type t)
+    {
+        return r.population_type() == static_cast<std::uint32_t>(t);
+    }
+
+    std::vector<std::size_t>
+    diploid_indexes(const population_file_reader& r, py::object indexes)
+    {
+        if (indexes.is_none())
+            {
+                std::vector<std::size_t> rv(r.metadata().N);
+                std::iota(rv.begin(), rv.end(), 0);
+                return rv;
+            }
+        return indexes.cast<std::vector<std::size_t>>();
+    }
+
+    static const auto POPULATION_FILE_DOCSTRING = R"delim(
+    Read parts of a population from a file written by tofile.
+
+    :param filename: The file name.
+
+    Opening the file only reads its header.  Each function
+    then reads only the data that it returns, so that getting,
+    e.g., the mutations from a large population is much
+    faster than reading the entire population.
+
+    .. versionadded:: 0.1.3
+    )delim";
+
+    static const auto POPULATION_FILE_DIPLOIDS_DOCSTRING = R"delim(
+    Read diploids.
+
+    :param indexes: (None) Indexes of diploids.  If None,
+        all diploids are read.
+
+    :raises IndexError: if an index is out of range.
+    )delim";
+
+    static const auto POPULATION_FILE_GAMETES_DOCSTRING = R"delim(
+    Read the gametes of diploids.  There are 2*nloci gametes
+    per diploid, ordered as first, second for each locus.
+    The mutation keys in each gamete refer to the mutations
+    in the file.
+
+    :param indexes: (None) Indexes of diploids.  If None,
+        all diploids are read.
+
+    :raises IndexError: if an index is out of range.
+    )delim";
+
+    static const auto XOSHIRO256_DOCSTRING = R"delim(
+    Random number generator based on xoshiro256**.
+
+    This is a :class:`fwdpy11.fwdpy11_types.GSLrng`, and may be
+    used wherever one is expected.  Draws are cheaper than for
+    the Mersenne twister, and the stream may be split into
+    independent substreams.  When simulating with multiple
+    threads, each thread is given its own substream.
+
+    .. versionadded:: 0.1.3
+    )delim";
 }
 
 PYBIND11_PLUGIN(fwdpy11_types)
@@ -138,6 +336,22 @@ PYBIND11_PLUGIN(fwdpy11_types)
         .def(py::init<unsigned>(),
              "Constructor takes unsigned integer as a seed");
 
+    py::class_<fwdpy11::xoshiro256_rng, fwdpy11::GSLrng_t>(
+        m, "Xoshiro256", XOSHIRO256_DOCSTRING)
+        .def(py::init<unsigned long>(),
+             "Constructor takes unsigned integer as a seed")
+        .def("jump", &fwdpy11::xoshiro256_rng::jump,
+             "Advance the generator by :math:`2^{128}` draws.")
+        .def("substreams", &fwdpy11::xoshiro256_rng::substreams,
+             R"delim(
+             Return a list of non-overlapping generators,
+             for example one per replicate simulation.
+             This generator is advanced past all of them.
+
+             :param n: Number of generators.
+             )delim",
+             py::arg("n"));
+
     py::class_<fwdpy11::diploid_t>(
         m, "SingleLocusDiploid",
         "Diploid data type for a single (usually contiguous) genomic region")
@@ -171,6 +385,15 @@ PYBIND11_PLUGIN(fwdpy11_types)
         "C++ representation of a list of "
         ":class:`fwdpy11.fwdpy11_types."
         "SingleLocusDiploid`.  Typically, access will be read-only.")
+        .def("view",
+             [](py::object self) {
+                 const auto& diploids
+                     = self.cast<const fwdpy11::dipvector_t&>();
+                 return make_readonly_view(
+                     diploid_view_dtype(), diploids.data(), diploids.size(),
+                     sizeof(fwdpy11::diploid_t), self);
+             },
+             VIEW_DOCSTRING)
         .def("trait_array",
              [](const fwdpy11::dipvector_t& diploids) {
                  std::vector<diploid_traits> rv;
@@ -420,7 +643,16 @@ PYBIND11_PLUGIN(fwdpy11_types)
 
     py::bind_vector<std::vector<KTfwd::uint_t>>(
         m, "VectorUint32", "Vector of unsigned 32-bit integers.",
-        py::buffer_protocol());
+        py::buffer_protocol())
+        .def("view",
+             [](py::object self) {
+                 const auto& v
+                     = self.cast<const std::vector<KTfwd::uint_t>&>();
+                 return make_readonly_view(py::dtype::of<KTfwd::uint_t>(),
+                                           v.data(), v.size(),
+                                           sizeof(KTfwd::uint_t), self);
+             },
+             VIEW_DOCSTRING);
     py::bind_vector<fwdpy11::gcont_t>(m, "GameteContainer",
                                       "C++ representations of a list of "
                                       ":class:`fwdpy11.fwdpp_types.Gamete`.  "
@@ -461,6 +693,14 @@ PYBIND11_PLUGIN(fwdpy11_types)
         "C++ representation of a list of "
         ":class:`fwdpy11.fwdpp_types.Mutation`.  "
         "Typically, access will be read-only.")
+        .def("view",
+             [](py::object self) {
+                 const auto& mutations = self.cast<const fwdpy11::mcont_t&>();
+                 return make_readonly_view(
+                     mutation_view_dtype(), mutations.data(), mutations.size(),
+                     sizeof(KTfwd::popgenmut), self);
+             },
+             VIEW_DOCSTRING)
         .def("array",
              [](const fwdpy11::mcont_t& mc) {
                  std::vector<flattened_popgenmut> rv;
@@ -501,11 +741,13 @@ PYBIND11_PLUGIN(fwdpy11_types)
 
     // Expose the type based on fwdpp's "sugar"
     // layer
-    py::class_<fwdpy11::singlepop_t, singlepop_sugar_base>(
+    py::class_<fwdpy11::singlepop_t, singlepop_sugar_base> slocuspop(
         m, "SlocusPop",
         "Population object representing a single "
         "deme and a "
-        "single genomic region.")
+        "single genomic region.");
+
+    slocuspop
         .def(py::init<unsigned>(), "Construct with an unsigned integer "
                                    "representing the initial "
                                    "population size.")
@@ -543,11 +785,14 @@ PYBIND11_PLUGIN(fwdpy11_types)
         .def("__eq__",
              [](const fwdpy11::singlepop_t& lhs,
                 const fwdpy11::singlepop_t& rhs) { return lhs == rhs; });
+    add_file_io<fwdpy11::singlepop_t>(slocuspop);
 
-    py::class_<fwdpy11::multilocus_t, multilocus_sugar_base>(
+    py::class_<fwdpy11::multilocus_t, multilocus_sugar_base> mlocuspop(
         m, "MlocusPop",
         "Representation of a multi-locus, single "
-        "deme system.")
+        "deme system.");
+
+    mlocuspop
         .def(py::init<unsigned, unsigned>(), py::arg("N"), py::arg("nloci"),
              "Construct with population size and "
              "number of loci.")
@@ -587,14 +832,17 @@ PYBIND11_PLUGIN(fwdpy11_types)
         .def("__eq__",
              [](const fwdpy11::multilocus_t& lhs,
                 const fwdpy11::multilocus_t& rhs) { return lhs == rhs; });
+    add_file_io<fwdpy11::multilocus_t>(mlocuspop);
 
     py::class_<fwdpy11::singlepop_gm_vec_t,
-               singlepop_generalmut_vec_sugar_base>(
-        m, "SlocusPopGeneralMutVec",
-        "Single-deme object using "
-        ":class:`fwpy11.fwdpp_types.GeneralMutVec`"
-        " as "
-        "the mutation type.")
+               singlepop_generalmut_vec_sugar_base>
+        slocuspop_gm_vec(m, "SlocusPopGeneralMutVec",
+                         "Single-deme object using "
+                         ":class:`fwpy11.fwdpp_types.GeneralMutVec`"
+                         " as "
+                         "the mutation type.");
+
+    slocuspop_gm_vec
         .def(py::init<unsigned>(), py::arg("N"),
              "Construct object with N diploids.")
         .def("clear", &fwdpy11::singlepop_gm_vec_t::clear,
@@ -632,5 +880,118 @@ PYBIND11_PLUGIN(fwdpy11_types)
                           const fwdpy11::singlepop_gm_vec_t& rhs) {
             return lhs == rhs;
         });
+    add_file_io<fwdpy11::singlepop_gm_vec_t>(slocuspop_gm_vec);
+
+    py::class_<population_file_reader>(m, "PopulationFile",
+                                       POPULATION_FILE_DOCSTRING)
+        .def(py::init<std::string>(), py::arg("filename"))
+        .def_property_readonly(
+            "poptype",
+            [](const population_file_reader& r) -> const char* {
+                if (is_poptype(r, population_type::slocus))
+                    return "SlocusPop";
+                if (is_poptype(r, population_type::mlocus))
+                    return "MlocusPop";
+                if (is_poptype(r, population_type::slocus_gm_vec))
+                    return "SlocusPopGeneralMutVec";
+                throw std::invalid_argument("unknown population type");
+            },
+            "The name of the population type in the file.")
+        .def_property_readonly("generation",
+                               [](const population_file_reader& r) {
+                                   return r.metadata().generation;
+                               },
+                               "The generation of the population.")
+        .def_property_readonly("N",
+                               [](const population_file_reader& r) {
+                                   return r.metadata().N;
+                               },
+                               "The population size.")
+        .def_property_readonly("nloci",
+                               [](const population_file_reader& r) {
+                                   return r.metadata().nloci;
+                               },
+                               "The number of loci.")
+        .def("mutations",
+             [](const population_file_reader& r) -> py::object {
+                 if (is_poptype(r, population_type::slocus_gm_vec))
+                     {
+                         return py::cast(without_gil([&r]() {
+                             return r.mutations<
+                                 std::vector<KTfwd::generalmut_vec>>();
+                         }));
+                     }
+                 return py::cast(without_gil([&r]() {
+                     return r.mutations<fwdpy11::mcont_t>();
+                 }));
+             },
+             "Read the mutations.")
+        .def("mcounts",
+             [](const population_file_reader& r) {
+                 return without_gil([&r]() { return r.mcounts(); });
+             },
+             "Read the mutation counts.")
+        .def("fixations",
+             [](const population_file_reader& r) -> py::object {
+                 if (is_poptype(r, population_type::slocus_gm_vec))
+                     {
+                         return py::cast(without_gil([&r]() {
+                             return r.fixations<
+                                 std::vector<KTfwd::generalmut_vec>>();
+                         }));
+                     }
+                 return py::cast(without_gil([&r]() {
+                     return r.fixations<fwdpy11::mcont_t>();
+                 }));
+             },
+             "Read the fixations.")
+        .def("fixation_times",
+             [](const population_file_reader& r) {
+                 return without_gil([&r]() { return r.fixation_times(); });
+             },
+             "Read the fixation times.")
+        .def("diploids",
+             [](const population_file_reader& r,
+                py::object indexes) -> py::object {
+                 const auto i = diploid_indexes(r, indexes);
+                 if (is_poptype(r, population_type::mlocus))
+                     {
+                         return py::cast(without_gil([&r, &i]() {
+                             return r.diploids<
+                                 std::vector<fwdpy11::dipvector_t>>(i);
+                         }));
+                     }
+                 return py::cast(without_gil([&r, &i]() {
+                     return r.diploids<fwdpy11::dipvector_t>(i);
+                 }));
+             },
+             py::arg("indexes") = py::none(),
+             POPULATION_FILE_DIPLOIDS_DOCSTRING)
+        .def("gametes",
+             [](const population_file_reader& r, py::object indexes) {
+                 const auto i = diploid_indexes(r, indexes);
+                 return without_gil([&r, &i]() { return r.gametes(i); });
+             },
+             py::arg("indexes") = py::none(),
+             POPULATION_FILE_GAMETES_DOCSTRING)
+        .def("load",
+             [](const population_file_reader& r) -> py::object {
+                 if (is_poptype(r, population_type::mlocus))
+                     {
+                         return py::cast(without_gil([&r]() {
+                             return r.load<fwdpy11::multilocus_t>();
+                         }));
+                     }
+                 if (is_poptype(r, population_type::slocus_gm_vec))
+                     {
+                         return py::cast(without_gil([&r]() {
+                             return r.load<fwdpy11::singlepop_gm_vec_t>();
+                         }));
+                     }
+                 return py::cast(without_gil([&r]() {
+                     return r.load<fwdpy11::singlepop_t>();
+                 }));
+             },
+             "Read the entire population.");
     return m.ptr();
 }
@@ -18,6 +18,7 @@
 //
 
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <fwdpy11/rng.hpp>
 #include <gsl/gsl_randist.h>
 
@@ -58,5 +59,36 @@ PYBIND11_PLUGIN(gsl_random)
           },
           "Geometric distribution parameterized by success probability.");
 
+    m.def("uniform_block",
+          [](const fwdpy11::GSLrng_t& rng, const std::size_t n) {
+              py::array_t<double> rv(n);
+              fwdpy11::fill_uniform(rng, rv.mutable_data(), n);
+              return rv;
+          },
+          py::arg("rng"), py::arg("n"),
+          R"delim(
+          Return a numpy array of n uniform deviates on the
+          interval [0,1).  The values are the same as n calls to
+          :func:`fwdpy11.gsl_random.gsl_rng_uniform`.
+
+          .. versionadded:: 0.1.3
+          )delim");
+
+    m.def("gaussian_block",
+          [](const fwdpy11::GSLrng_t& rng, const double sd,
+             const std::size_t n) {
+              py::array_t<double> rv(n);
+              fwdpy11::fill_gaussian(rng, sd, rv.mutable_data(), n);
+              return rv;
+          },
+          py::arg("rng"), py::arg("sd"), py::arg("n"),
+          R"delim(
+          Return a numpy array of n Gaussian deviates with mean
+          zero.  The values are the same as n calls to
+          :func:`fwdpy11.gsl_random.gsl_ran_gaussian_ziggurat`.
+
+          .. versionadded:: 0.1.3
+          )delim");
+
     return m.ptr();
 }
@@ -12,53 +12,10 @@
 #include <fwdpy11/rng.hpp>
 #include <fwdpy11/multilocus.hpp>
 #include <fwdpy11/fitness/fitness.hpp>
+#include <fwdpy11/fitness/multilocus_aggregators.hpp>
 
 namespace py = pybind11;
 
-struct aggregate_additive_fitness
-{
-    inline double
-    operator()(const py::array_t<double>& g) const noexcept
-    {
-        auto s = g.size();
-        return std::max(0., std::accumulate(g.data(), g.data() + s, 0.0)
-                                - (s - 1));
-    }
-};
-
-struct aggregate_mult_fitness
-{
-    inline double
-    operator()(const py::array_t<double>& g) const noexcept
-    {
-        auto s = g.size();
-        return std::max(0., std::accumulate(g.data(), g.data() + s, 1.0,
-                                            std::multiplies<double>()));
-    }
-};
-
-struct aggregate_additive_trait
-{
-    inline double
-    operator()(const py::array_t<double>& g) const noexcept
-    {
-        return std::accumulate(g.data(), g.data() + g.size(), 0.0);
-    }
-};
-
-struct aggregate_mult_trait
-{
-    inline double
-    operator()(const py::array_t<double>& g) const noexcept
-    {
-        auto s = g.size();
-        return std::accumulate(
-                   g.data(), g.data() + s, 1.0,
-                   [](double prod, double v) { return prod * (1. + v); })
-               - 1.0;
-    }
-};
-
 #define AGGREGATOR(CPPNAME, PYNAME, DOCSTRING)                                \
     py::class_<CPPNAME>(m, PYNAME, DOCSTRING)                                 \
         .def(py::init<>())                                                    \
@@ -139,16 +96,16 @@ PYBIND11_PLUGIN(multilocus)
                  new (&mw) fwdpy11::multilocus_genetic_value(l.cast<ff_vec>());
              });
 
-    AGGREGATOR(aggregate_additive_fitness, "AggAddFitness",
+    AGGREGATOR(fwdpy11::aggregate_additive_fitness, "AggAddFitness",
                "Map genetic values from a multi-locus diploid to fitness "
                "under an additive model.");
-    AGGREGATOR(aggregate_additive_trait, "AggAddTrait",
+    AGGREGATOR(fwdpy11::aggregate_additive_trait, "AggAddTrait",
                "Map genetic values from a multi-locus diploid to trait value "
                "under an additive model.");
-    AGGREGATOR(aggregate_mult_fitness, "AggMultFitness",
+    AGGREGATOR(fwdpy11::aggregate_mult_fitness, "AggMultFitness",
                "Map genetic values from a multi-locus diploid to fitness "
                "under an multiplicative model.");
-    AGGREGATOR(aggregate_mult_trait, "AggMultTrait",
+    AGGREGATOR(fwdpy11::aggregate_mult_trait, "AggMultTrait",
                "Map genetic values from a multi-locus diploid to trait value "
                "under an multiplicative model.");
 
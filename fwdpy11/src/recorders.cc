@@ -0,0 +1,179 @@
+//
+// Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+//
+// This file is part of fwdpy11.
+//
+// fwdpy11 is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// fwdpy11 is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <cstdint>
+#include <vector>
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl_bind.h>
+#include <fwdpy11/types.hpp>
+#include <fwdpy11/recorders.hpp>
+
+namespace py = pybind11;
+
+PYBIND11_MAKE_OPAQUE(std::vector<fwdpy11::mean_fitness_record>);
+PYBIND11_MAKE_OPAQUE(std::vector<fwdpy11::trait_record>);
+PYBIND11_MAKE_OPAQUE(std::vector<fwdpy11::segsites_record>);
+PYBIND11_MAKE_OPAQUE(std::vector<fwdpy11::fixation_record>);
+
+namespace
+{
+    static const auto NSAMPLES_DOCSTRING = R"delim(
+    :param interval: Record data every interval generations.
+    :param nsamples: (0) The expected number of samples.  Memory for this
+        many records is allocated up front.
+    )delim";
+
+    static const auto DATA_DOCSTRING = R"delim(
+    The recorded data.  This object supports the buffer protocol, 
+    so numpy.array(x.data, copy=False) is a structured array
+    that does not copy the data.  Such a view is invalidated if 
+    more data are recorded.
+    )delim";
+}
+
+PYBIND11_PLUGIN(recorders)
+{
+    py::module m("recorders", "Temporal samplers implemented in C++.");
+
+    PYBIND11_NUMPY_DTYPE(fwdpy11::mean_fitness_record, generation, wbar);
+    PYBIND11_NUMPY_DTYPE(fwdpy11::trait_record, generation, mean, variance);
+    PYBIND11_NUMPY_DTYPE(fwdpy11::segsites_record, generation, neutral,
+                         selected);
+    PYBIND11_NUMPY_DTYPE(fwdpy11::fixation_record, generation, origin, pos,
+                         s, h, neutral);
+
+    py::bind_vector<std::vector<fwdpy11::mean_fitness_record>>(
+        m, "VecMeanFitness", py::buffer_protocol(),
+        "Vector of (generation, wbar) records.");
+    py::bind_vector<std::vector<fwdpy11::trait_record>>(
+        m, "VecTraitStats", py::buffer_protocol(),
+        "Vector of (generation, mean, variance) records.");
+    py::bind_vector<std::vector<fwdpy11::segsites_record>>(
+        m, "VecSegSites", py::buffer_protocol(),
+        "Vector of (generation, neutral, selected) records.");
+    py::bind_vector<std::vector<fwdpy11::fixation_record>>(
+        m, "VecFixations", py::buffer_protocol(),
+        "Vector of (generation, origin, pos, s, h, neutral) records.");
+
+    py::class_<fwdpy11::native_recorder>(m, "NativeRecorder",
+                                         R"delim(
+        Base class for temporal samplers implemented in C++.  
+        
+        The evolve functions call these objects directly, 
+        without going through Python.
+
+        .. versionadded:: 0.1.3
+        )delim")
+        .def_readonly("interval", &fwdpy11::native_recorder::interval,
+                      "The sampling interval, in generations.")
+        .def("__call__",
+             [](fwdpy11::native_recorder& r, const fwdpy11::singlepop_t& pop) {
+                 r(pop);
+             })
+        .def("__call__",
+             [](fwdpy11::native_recorder& r,
+                const fwdpy11::multilocus_t& pop) { r(pop); });
+
+    py::class_<fwdpy11::mean_fitness_recorder, fwdpy11::native_recorder>(
+        m, "RecordMeanFitness",
+        "Record mean fitness.\n\n.. versionadded:: 0.1.3")
+        .def(py::init<unsigned, std::size_t>(), py::arg("interval") = 1,
+             py::arg("nsamples") = 0, NSAMPLES_DOCSTRING)
+        .def_readonly("data", &fwdpy11::mean_fitness_recorder::data,
+                      DATA_DOCSTRING);
+
+    py::class_<fwdpy11::trait_recorder, fwdpy11::native_recorder>(
+        m, "RecordTraitValues", R"delim(
+        Record the mean and variance of genetic values.
+        The variance is calculated using N, not N-1, 
+        in the denominator.
+
+        .. versionadded:: 0.1.3
+        )delim")
+        .def(py::init<unsigned, std::size_t>(), py::arg("interval") = 1,
+             py::arg("nsamples") = 0, NSAMPLES_DOCSTRING)
+        .def_readonly("data", &fwdpy11::trait_recorder::data,
+                      DATA_DOCSTRING);
+
+    py::class_<fwdpy11::segsites_recorder, fwdpy11::native_recorder>(
+        m, "RecordSegSites", R"delim(
+        Record the number of segregating neutral and selected mutations.
+
+        .. versionadded:: 0.1.3
+        )delim")
+        .def(py::init<unsigned, std::size_t>(), py::arg("interval") = 1,
+             py::arg("nsamples") = 0, NSAMPLES_DOCSTRING)
+        .def_readonly("data", &fwdpy11::segsites_recorder::data,
+                      DATA_DOCSTRING);
+
+    py::class_<fwdpy11::sfs_recorder, fwdpy11::native_recorder>(
+        m, "RecordSFS", R"delim(
+        Record the site frequency spectrum.
+
+        A mutation present in n of 2N copies is counted in
+        bin (n-1)*nbins/(2N-1).  Thus, if nbins is 2N-1, element
+        i of a row is the number of mutations present in i+1 copies.
+
+        .. versionadded:: 0.1.3
+        )delim")
+        .def(py::init<unsigned, std::size_t, std::size_t>(),
+             py::arg("interval"), py::arg("nbins"), py::arg("nsamples") = 0,
+             R"delim(
+             :param interval: Record data every interval generations.
+             :param nbins: The number of frequency bins.
+             :param nsamples: (0) The expected number of samples.
+             )delim")
+        .def_readonly("nbins", &fwdpy11::sfs_recorder::nbins)
+        .def_property_readonly(
+            "generations",
+            [](py::object self) {
+                const auto& r = self.cast<const fwdpy11::sfs_recorder&>();
+                return py::array_t<std::uint32_t>(
+                    { r.generations.size() }, { sizeof(std::uint32_t) },
+                    r.generations.data(), self);
+            },
+            "The generation of each sample, as a numpy array that "
+            "does not copy the data.")
+        .def_property_readonly(
+            "counts",
+            [](py::object self) {
+                const auto& r = self.cast<const fwdpy11::sfs_recorder&>();
+                return py::array_t<std::uint32_t>(
+                    { r.generations.size(), r.nbins },
+                    { r.nbins * sizeof(std::uint32_t),
+                      sizeof(std::uint32_t) },
+                    r.counts.data(), self);
+            },
+            "A 2d numpy array with one row per sample. "
+            "The data are not copied.");
+
+    py::class_<fwdpy11::fixation_recorder, fwdpy11::native_recorder>(
+        m, "RecordFixations", R"delim(
+        Record fixations.  Each sample contains the fixations
+        that happened since the previous sample.  The generation
+        field of each record is the fixation time.
+
+        .. versionadded:: 0.1.3
+        )delim")
+        .def(py::init<unsigned>(), py::arg("interval") = 1)
+        .def_readonly("data", &fwdpy11::fixation_recorder::data,
+                      DATA_DOCSTRING);
+
+    return m.ptr();
+}
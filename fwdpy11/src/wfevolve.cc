@@ -21,61 +21,227 @@
 #include <pybind11/numpy.h>
 #include <pybind11/functional.h>
 #include <functional>
+#include <memory>
+#include <vector>
 #include <cmath>
 #include <stdexcept>
 #include <fwdpp/diploid.hh>
-#include <fwdpp/sugar/GSLrng_t.hpp>
 #include <fwdpp/extensions/regions.hpp>
+#include <fwdpy11/rng.hpp>
+#include <fwdpy11/thread_pool.hpp>
 #include <fwdpy11/samplers.hpp>
 #include <fwdpy11/fitness/fitness.hpp>
+#include <fwdpy11/fitness/builtin_dispatch.hpp>
+#include <fwdpy11/fitness/gvalue_cache.hpp>
 #include <fwdpy11/rules/wf_rules.hpp>
 #include <fwdpy11/sim_functions.hpp>
 #include <fwdpy11/evolve/slocuspop.hpp>
+#include <fwdpy11/evolve/callback_schedule.hpp>
 namespace py = pybind11;
 
-template <typename bound_mmodels, typename bound_recmodels,
+template <typename fitness_fxn, typename gvalue_cache_t,
+          typename bound_mmodels, typename bound_recmodels,
           typename mut_removal_policy>
 void
 evolve_common(const fwdpy11::GSLrng_t& rng, fwdpy11::singlepop_t& pop,
               fwdpy11::wf_rules& rules, py::array_t<std::uint32_t> popsizes,
               const double mu_neutral, const double mu_selected,
               const bound_mmodels& mmodels, const bound_recmodels& recmap,
-              fwdpy11::single_locus_fitness& fitness,
+              const KTfwd::extensions::discrete_rec_model& rmodel,
+              const double recrate, fwdpy11::single_locus_fitness& fitness,
+              const fitness_fxn& fitness_callback, gvalue_cache_t& cache,
               fwdpy11::singlepop_temporal_sampler& recorder,
+              const fwdpy11::callback_schedule& record_when,
               const double selfing_rate, const mut_removal_policy& mp,
-              const bool remove_selected_fixations)
+              const bool remove_selected_fixations, const unsigned nthreads,
+              const bool deduplicate_gametes, const bool batch_random_draws)
 {
     auto generations = popsizes.size();
-    auto fitness_callback = fitness.callback();
+
+    // Set up for generating offspring in stages, which is required
+    // for multiple threads and for de-duplication of gametes.
+    // Otherwise, nothing is allocated and rng is not touched.
+    const bool staged = (nthreads > 1 || deduplicate_gametes);
+    std::unique_ptr<fwdpy11::thread_pool> pool(nullptr);
+    auto thread_rngs = staged ? fwdpy11::make_thread_rngs(rng, nthreads)
+                              : std::vector<fwdpy11::GSLrng_t>();
+    std::vector<bound_recmodels> thread_recmaps;
+    fwdpy11::offspring_staging staging;
+    fwdpy11::gamete_dedup_index dedup;
+    fwdpy11::offspring_draws draws;
+    if (staged)
+        {
+            pool.reset(new fwdpy11::thread_pool(nthreads));
+            if (nthreads > 1)
+                rules.pool = pool.get();
+            for (auto& r : thread_rngs)
+                {
+                    thread_recmaps.emplace_back(KTfwd::extensions::bind_drm(
+                        rmodel, pop.gametes, pop.mutations, r.get(),
+                        recrate));
+                }
+        }
+
+    // wf_rules is final, so these calls are not virtual
+    const auto pick1 = [&rules](const fwdpy11::GSLrng_t& r,
+                                const fwdpy11::singlepop_t& p) {
+        return rules.pick1(r, p);
+    };
+    // When drawing in blocks, selfing is decided by draws
+    const double pick2_selfing_rate = batch_random_draws ? 0. : selfing_rate;
+    const auto pick2
+        = [&rules, pick2_selfing_rate](const fwdpy11::GSLrng_t& r,
+                                       const fwdpy11::singlepop_t& p,
+                                       const std::size_t p1) {
+              return rules.pick2(r, p, p1, pick2_selfing_rate);
+          };
+    const auto update = [&rules, &cache](const fwdpy11::GSLrng_t& r,
+                                         fwdpy11::diploid_t& offspring,
+                                         const fwdpy11::singlepop_t& p,
+                                         const std::size_t p1,
+                                         const std::size_t p2) {
+        rules.update(r, offspring, p, p1, p2);
+        cache.offspring_created(offspring, p, p1, p2);
+    };
+
+    fwdpy11::recycling_bins bins(pop);
+    fwdpy11::fixation_batch fixations;
     fitness.update(pop);
+    cache.refresh(pop);
     auto wbar = rules.w(pop, fitness_callback);
     for (unsigned generation = 0; generation < generations;
          ++generation, ++pop.generation)
         {
             const auto N_next = popsizes.at(generation);
-            fwdpy11::evolve_generation(
-                rng, pop, N_next, mu_neutral + mu_selected, mmodels, recmap,
-                std::bind(&fwdpy11::wf_rules::pick1, &rules,
-                          std::placeholders::_1, std::placeholders::_2),
-                std::bind(&fwdpy11::wf_rules::pick2, &rules,
-                          std::placeholders::_1, std::placeholders::_2,
-                          std::placeholders::_3, selfing_rate),
-                std::bind(&fwdpy11::wf_rules::update, &rules,
-                          std::placeholders::_1, std::placeholders::_2,
-                          std::placeholders::_3, std::placeholders::_4,
-                          std::placeholders::_5),
-                mp);
+            if (batch_random_draws)
+                {
+                    draws.fill(rng, N_next, selfing_rate);
+                    if (!pool)
+                        {
+                            draws.fill_mutations(rng, N_next,
+                                                 mu_neutral + mu_selected);
+                        }
+                }
+            if (pool)
+                {
+                    fwdpy11::evolve_generation_threaded(
+                        rng, *pool, thread_rngs, thread_recmaps, staging, pop,
+                        bins, N_next, mu_neutral + mu_selected, mmodels, pick1,
+                        pick2, update, mp,
+                        deduplicate_gametes ? &dedup : nullptr,
+                        batch_random_draws ? &draws : nullptr);
+                }
+            else
+                {
+                    fwdpy11::evolve_generation(
+                        rng, pop, bins, N_next, mu_neutral + mu_selected,
+                        mmodels, recmap, pick1, pick2, update, mp,
+                        batch_random_draws ? &draws : nullptr);
+                }
             pop.N = N_next;
-            fwdpy11::update_mutations(pop.mutations, pop.fixations,
-                                      pop.fixation_times, pop.mut_lookup,
-                                      pop.mcounts, pop.generation, 2 * pop.N,
-                                      remove_selected_fixations);
+            fwdpy11::update_mutations(
+                pop.mutations, pop.fixations, pop.fixation_times,
+                pop.mut_lookup, pop.mcounts, pop.generation, 2 * pop.N,
+                remove_selected_fixations, fixations,
+                bins.changed_mutations());
+            bins.recycle_mutations(pop.mcounts);
             fitness.update(pop);
-            auto wbar = rules.w(pop, fitness_callback);
-            recorder(pop);
+            cache.refresh(pop);
+            wbar = rules.w(pop, fitness_callback);
+            if (record_when(generation))
+                {
+                    recorder(pop);
+                }
         }
 }
 
+template <typename bound_mmodels, typename bound_recmodels>
+struct evolve_visitor
+/*!
+  Passed to fwdpy11::dispatch_single_locus_fitness so that
+  evolve_common is instantiated for the concrete type of the
+  fitness callback.
+*/
+{
+    const fwdpy11::GSLrng_t& rng;
+    fwdpy11::singlepop_t& pop;
+    py::array_t<std::uint32_t> popsizes;
+    const double mu_neutral, mu_selected;
+    const bound_mmodels& mmodels;
+    const bound_recmodels& recmap;
+    const KTfwd::extensions::discrete_rec_model& rmodel;
+    const double recrate;
+    fwdpy11::single_locus_fitness& fitness;
+    fwdpy11::singlepop_temporal_sampler& recorder;
+    const fwdpy11::callback_schedule& record_when;
+    const double selfing_rate;
+    const bool remove_selected_fixations;
+    const unsigned nthreads;
+    const bool cache_gvalues;
+    const bool deduplicate_gametes;
+    const bool batch_random_draws;
+
+    template <typename fitness_fxn, typename gvalue_cache_t>
+    void
+    run(const fitness_fxn& fitness_callback, gvalue_cache_t& cache)
+    {
+        auto rules = fwdpy11::wf_rules();
+        if (remove_selected_fixations)
+            {
+                evolve_common(rng, pop, rules, popsizes, mu_neutral,
+                              mu_selected, mmodels, recmap, rmodel, recrate,
+                              fitness, fitness_callback, cache, recorder,
+                              record_when, selfing_rate, std::true_type(),
+                              true, nthreads, deduplicate_gametes,
+                              batch_random_draws);
+            }
+        else
+            {
+                evolve_common(rng, pop, rules, popsizes, mu_neutral,
+                              mu_selected, mmodels, recmap, rmodel, recrate,
+                              fitness, fitness_callback, cache, recorder,
+                              record_when, selfing_rate,
+                              KTfwd::remove_neutral(), false, nthreads,
+                              deduplicate_gametes, batch_random_draws);
+            }
+    }
+
+    template <typename fitness_fxn>
+    void
+    run_cached(const fitness_fxn& fitness_callback, std::true_type)
+    {
+        typename fwdpy11::gvalue_cache_traits<fitness_fxn>::type cache(
+            fitness_callback.scaling);
+        run(cache, cache);
+    }
+
+    template <typename fitness_fxn>
+    void
+    run_cached(const fitness_fxn&, std::false_type)
+    {
+        throw std::invalid_argument(
+            "caching of genetic values requires one of the built-in "
+            "additive or multiplicative models");
+    }
+
+    template <typename fitness_fxn>
+    void
+    operator()(const fitness_fxn& fitness_callback)
+    {
+        if (cache_gvalues)
+            {
+                run_cached(fitness_callback,
+                           typename fwdpy11::gvalue_cache_traits<
+                               fitness_fxn>::supported());
+            }
+        else
+            {
+                fwdpy11::no_gvalue_cache cache;
+                run(fitness_callback, cache);
+            }
+    }
+};
+
 // Evolve the population for some amount of time with mutation and
 // recombination
 void
@@ -86,12 +252,17 @@ evolve_singlepop_regions_cpp(
     const KTfwd::extensions::discrete_mut_model& mmodel,
     const KTfwd::extensions::discrete_rec_model& rmodel,
     fwdpy11::single_locus_fitness& fitness,
-    fwdpy11::singlepop_temporal_sampler recorder, const double selfing_rate,
-    const bool remove_selected_fixations = false)
+    py::object recorder_object, const double selfing_rate,
+    const bool remove_selected_fixations = false, const unsigned nthreads = 1,
+    const bool cache_gvalues = false, py::object record_schedule = py::none(),
+    const bool deduplicate_gametes = false,
+    const bool batch_random_draws = false)
 {
     const auto generations = popsizes.size();
     if (!generations)
         throw std::runtime_error("empty list of population sizes");
+    if (!nthreads)
+        throw std::runtime_error("number of threads must be > 0");
     if (mu_neutral < 0.)
         {
             throw std::runtime_error("negative neutral mutation rate: "
@@ -116,20 +287,21 @@ evolve_singlepop_regions_cpp(
     const auto mmodels = KTfwd::extensions::bind_dmm(
         mmodel, pop.mutations, pop.mut_lookup, rng.get(), mu_neutral,
         mu_selected, &pop.generation);
+    auto recorder = fwdpy11::make_temporal_sampler<fwdpy11::singlepop_t>(
+        recorder_object);
     ++pop.generation;
-    auto rules = fwdpy11::wf_rules();
-    if (remove_selected_fixations)
-        {
-            evolve_common(rng, pop, rules, popsizes, mu_neutral, mu_selected,
-                          mmodels, recmap, fitness, recorder, selfing_rate,
-                          std::true_type(), true);
-        }
-    else
-        {
-            evolve_common(rng, pop, rules, popsizes, mu_neutral, mu_selected,
-                          mmodels, recmap, fitness, recorder, selfing_rate,
-                          KTfwd::remove_neutral(), false);
-        }
+    const fwdpy11::callback_schedule record_when(record_schedule,
+                                                 pop.generation, generations);
+    evolve_visitor<decltype(mmodels), decltype(recmap)> v{
+        rng, pop, popsizes, mu_neutral, mu_selected, mmodels, recmap,
+        rmodel, recrate, fitness, recorder, record_when, selfing_rate,
+        remove_selected_fixations, nthreads, cache_gvalues,
+        deduplicate_gametes, batch_random_draws
+    };
+    // Built-in fitness models get their own instantiation
+    // of evolve_common.  Everything else goes through
+    // a std::function.
+    fwdpy11::dispatch_single_locus_fitness(fitness, v);
     --pop.generation;
 }
 
@@ -22,24 +22,228 @@
 #include <pybind11/functional.h>
 #include <pybind11/stl.h>
 #include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
 #include <tuple>
 #include <queue>
 #include <cmath>
 #include <stdexcept>
 #include <fwdpp/diploid.hh>
-#include <fwdpp/sugar/GSLrng_t.hpp>
 #include <fwdpp/extensions/regions.hpp>
+#include <fwdpy11/rng.hpp>
+#include <fwdpy11/thread_pool.hpp>
 #include <fwdpy11/samplers.hpp>
 #include <fwdpy11/fitness/fitness.hpp>
+#include <fwdpy11/fitness/builtin_dispatch.hpp>
+#include <fwdpy11/fitness/gvalue_cache.hpp>
 #include <fwdpy11/rules/qtrait.hpp>
 #include <fwdpy11/sim_functions.hpp>
 #include <fwdpy11/evolve/qtrait_api.hpp>
 #include <fwdpy11/evolve/slocuspop.hpp>
 #include <fwdpy11/evolve/mlocuspop.hpp>
+#include <fwdpy11/evolve/callback_schedule.hpp>
 #include <fwdpy11/multilocus.hpp>
 
 namespace py = pybind11;
 
+template <typename fitness_fxn, typename gvalue_cache_t,
+          typename bound_mmodel, typename bound_recmodel>
+void
+evolve_slocus_qtrait_common(
+    const fwdpy11::GSLrng_t &rng, fwdpy11::singlepop_t &pop,
+    py::array_t<std::uint32_t> popsizes, const double mu,
+    const bound_mmodel &mmodels, const bound_recmodel &recmap,
+    const KTfwd::extensions::discrete_rec_model &rmodel, const double recrate,
+    fwdpy11::single_locus_fitness &fitness,
+    const fitness_fxn &fitness_callback, gvalue_cache_t &cache,
+    fwdpy11::singlepop_temporal_sampler &recorder,
+    const fwdpy11::callback_schedule &record_when,
+    const fwdpy11::callback_schedule &update_when, const double selfing_rate,
+    const fwdpy11::trait_to_fitness_function &trait_to_fitness,
+    py::function &updater, const fwdpy11::single_locus_noise_function &noise,
+    py::function &noise_updater_fxn, const unsigned nthreads,
+    const bool deduplicate_gametes, const bool batch_random_draws)
+{
+    const auto generations = popsizes.size();
+    const bool updater_exists = static_cast<bool>(updater);
+    const bool noise_updater_exists = static_cast<bool>(noise_updater_fxn);
+    // De-duplication of gametes requires the staged path.
+    const bool staged = (nthreads > 1 || deduplicate_gametes);
+    std::unique_ptr<fwdpy11::thread_pool> pool(nullptr);
+    auto thread_rngs = staged ? fwdpy11::make_thread_rngs(rng, nthreads)
+                              : std::vector<fwdpy11::GSLrng_t>();
+    std::vector<bound_recmodel> thread_recmaps;
+    fwdpy11::offspring_staging staging;
+    fwdpy11::gamete_dedup_index dedup;
+    fwdpy11::offspring_draws draws;
+    if (staged)
+        {
+            pool.reset(new fwdpy11::thread_pool(nthreads));
+            for (auto &r : thread_rngs)
+                {
+                    thread_recmaps.emplace_back(KTfwd::extensions::bind_drm(
+                        rmodel, pop.gametes, pop.mutations, r.get(),
+                        recrate));
+                }
+        }
+
+    auto rules = fwdpy11::qtrait::qtrait_model_rules(trait_to_fitness, noise);
+    if (nthreads > 1)
+        rules.pool = pool.get();
+    // qtrait_model_rules is final, so these calls are not virtual
+    const auto pick1 = [&rules](const fwdpy11::GSLrng_t &r,
+                                const fwdpy11::singlepop_t &p) {
+        return rules.pick1(r, p);
+    };
+    // When drawing in blocks, selfing is decided by draws
+    const double pick2_selfing_rate = batch_random_draws ? 0. : selfing_rate;
+    const auto pick2
+        = [&rules, pick2_selfing_rate](const fwdpy11::GSLrng_t &r,
+                                       const fwdpy11::singlepop_t &p,
+                                       const std::size_t p1) {
+              return rules.pick2(r, p, p1, pick2_selfing_rate);
+          };
+    const auto update = [&rules, &cache](const fwdpy11::GSLrng_t &r,
+                                         fwdpy11::diploid_t &offspring,
+                                         const fwdpy11::singlepop_t &p,
+                                         const std::size_t p1,
+                                         const std::size_t p2) {
+        rules.update(r, offspring, p, p1, p2);
+        cache.offspring_created(offspring, p, p1, p2);
+    };
+    fwdpy11::recycling_bins bins(pop);
+    fwdpy11::fixation_batch fixations;
+    fitness.update(pop);
+    cache.refresh(pop);
+    auto wbar = rules.w(pop, fitness_callback);
+    for (unsigned generation = 0; generation < generations;
+         ++generation, ++pop.generation)
+        {
+            const auto N_next = popsizes.at(generation);
+            if (batch_random_draws)
+                {
+                    draws.fill(rng, N_next, selfing_rate);
+                    if (!pool)
+                        draws.fill_mutations(rng, N_next, mu);
+                }
+            if (pool)
+                {
+                    fwdpy11::evolve_generation_threaded(
+                        rng, *pool, thread_rngs, thread_recmaps, staging, pop,
+                        bins, N_next, mu, mmodels, pick1, pick2, update,
+                        KTfwd::remove_neutral(),
+                        deduplicate_gametes ? &dedup : nullptr,
+                        batch_random_draws ? &draws : nullptr);
+                }
+            else
+                {
+                    fwdpy11::evolve_generation(
+                        rng, pop, bins, N_next, mu, mmodels, recmap, pick1,
+                        pick2, update, KTfwd::remove_neutral(),
+                        batch_random_draws ? &draws : nullptr);
+                }
+
+            pop.N = N_next;
+            fwdpy11::update_mutations(
+                pop.mutations, pop.fixations, pop.fixation_times,
+                pop.mut_lookup, pop.mcounts, pop.generation, 2 * pop.N, false,
+                fixations, bins.changed_mutations());
+            bins.recycle_mutations(pop.mcounts);
+            fitness.update(pop);
+            cache.refresh(pop);
+            wbar = rules.w(pop, fitness_callback);
+            if (record_when(generation))
+                {
+                    recorder(pop);
+                }
+            if (updater_exists && update_when(generation))
+                {
+                    updater(pop);
+                }
+            if (noise_updater_exists && update_when(generation))
+                {
+                    noise_updater_fxn(pop.generation);
+                }
+        }
+}
+
+template <typename bound_mmodel, typename bound_recmodel>
+struct slocus_qtrait_visitor
+/*!
+  Passed to fwdpy11::dispatch_single_locus_fitness so that
+  evolve_slocus_qtrait_common is instantiated for the concrete
+  type of the genetic value callback.
+*/
+{
+    const fwdpy11::GSLrng_t &rng;
+    fwdpy11::singlepop_t &pop;
+    py::array_t<std::uint32_t> popsizes;
+    const double mu;
+    const bound_mmodel &mmodels;
+    const bound_recmodel &recmap;
+    const KTfwd::extensions::discrete_rec_model &rmodel;
+    const double recrate;
+    fwdpy11::single_locus_fitness &fitness;
+    fwdpy11::singlepop_temporal_sampler &recorder;
+    const fwdpy11::callback_schedule &record_when, &update_when;
+    const double selfing_rate;
+    const fwdpy11::trait_to_fitness_function &trait_to_fitness;
+    py::function &updater;
+    const fwdpy11::single_locus_noise_function &noise;
+    py::function &noise_updater_fxn;
+    const unsigned nthreads;
+    const bool cache_gvalues;
+    const bool deduplicate_gametes;
+    const bool batch_random_draws;
+
+    template <typename fitness_fxn, typename gvalue_cache_t>
+    void
+    run(const fitness_fxn &fitness_callback, gvalue_cache_t &cache)
+    {
+        evolve_slocus_qtrait_common(
+            rng, pop, popsizes, mu, mmodels, recmap, rmodel, recrate, fitness,
+            fitness_callback, cache, recorder, record_when, update_when,
+            selfing_rate, trait_to_fitness, updater, noise, noise_updater_fxn,
+            nthreads, deduplicate_gametes, batch_random_draws);
+    }
+
+    template <typename fitness_fxn>
+    void
+    run_cached(const fitness_fxn &fitness_callback, std::true_type)
+    {
+        typename fwdpy11::gvalue_cache_traits<fitness_fxn>::type cache(
+            fitness_callback.scaling);
+        run(cache, cache);
+    }
+
+    template <typename fitness_fxn>
+    void
+    run_cached(const fitness_fxn &, std::false_type)
+    {
+        throw std::invalid_argument(
+            "caching of genetic values requires one of the built-in "
+            "additive or multiplicative models");
+    }
+
+    template <typename fitness_fxn>
+    void
+    operator()(const fitness_fxn &fitness_callback)
+    {
+        if (cache_gvalues)
+            {
+                run_cached(fitness_callback,
+                           typename fwdpy11::gvalue_cache_traits<
+                               fitness_fxn>::supported());
+            }
+        else
+            {
+                fwdpy11::no_gvalue_cache cache;
+                run(fitness_callback, cache);
+            }
+    }
+};
+
 // Evolve the population for some amount of time with mutation and
 // recombination
 void
@@ -49,25 +253,24 @@ evolve_singlepop_regions_qtrait_cpp(
     const double mu_selected, const double recrate,
     const KTfwd::extensions::discrete_mut_model &mmodel,
     const KTfwd::extensions::discrete_rec_model &rmodel,
-    fwdpy11::single_locus_fitness &fitness,
-    fwdpy11::singlepop_temporal_sampler recorder, const double selfing_rate,
+    fwdpy11::single_locus_fitness &fitness, py::object recorder_object,
+    const double selfing_rate,
     fwdpy11::trait_to_fitness_function trait_to_fitness,
     py::object trait_to_fitness_updater,
-    fwdpy11::single_locus_noise_function noise, py::object noise_updater)
+    fwdpy11::single_locus_noise_function noise, py::object noise_updater,
+    const unsigned nthreads, const bool cache_gvalues,
+    py::object record_schedule, py::object update_schedule,
+    const bool deduplicate_gametes, const bool batch_random_draws)
 {
-    bool updater_exists = false;
     py::function updater;
     if (trait_to_fitness_updater != py::none())
         {
             updater = py::function(trait_to_fitness_updater);
-            updater_exists = true;
         }
-    bool noise_updater_exists = false;
     py::function noise_updater_fxn;
     if (noise_updater != py::none())
         {
             noise_updater_fxn = noise_updater;
-            noise_updater_exists = true;
         }
     const auto generations = popsizes.size();
     if (!generations)
@@ -87,7 +290,8 @@ evolve_singlepop_regions_qtrait_cpp(
             throw std::runtime_error("negative recombination rate: "
                                      + std::to_string(recrate));
         }
-    const auto fitness_callback = fitness.callback();
+    if (!nthreads)
+        throw std::runtime_error("number of threads must be > 0");
     pop.mutations.reserve(std::ceil(
         std::log(2 * pop.N)
         * (4. * double(pop.N) * (mu_neutral + mu_selected)
@@ -97,43 +301,24 @@ evolve_singlepop_regions_qtrait_cpp(
     const auto mmodels = KTfwd::extensions::bind_dmm(
         mmodel, pop.mutations, pop.mut_lookup, rng.get(), mu_neutral,
         mu_selected, &pop.generation);
+    auto recorder = fwdpy11::make_temporal_sampler<fwdpy11::singlepop_t>(
+        recorder_object);
     ++pop.generation;
-    auto rules = fwdpy11::qtrait::qtrait_model_rules(trait_to_fitness, noise);
-    fitness.update(pop);
-    auto wbar = rules.w(pop, fitness_callback);
-    for (unsigned generation = 0; generation < generations;
-         ++generation, ++pop.generation)
-        {
-            const auto N_next = popsizes.at(generation);
-            fwdpy11::evolve_generation(
-                rng, pop, N_next, mu_neutral + mu_selected, mmodels, recmap,
-                std::bind(&fwdpy11::qtrait::qtrait_model_rules::pick1, &rules,
-                          std::placeholders::_1, std::placeholders::_2),
-                std::bind(&fwdpy11::qtrait::qtrait_model_rules::pick2, &rules,
-                          std::placeholders::_1, std::placeholders::_2,
-                          std::placeholders::_3, selfing_rate),
-                std::bind(&fwdpy11::qtrait::qtrait_model_rules::update, &rules,
-                          std::placeholders::_1, std::placeholders::_2,
-                          std::placeholders::_3, std::placeholders::_4,
-                          std::placeholders::_5),
-                KTfwd::remove_neutral());
+    const fwdpy11::callback_schedule record_when(record_schedule,
+                                                 pop.generation, generations);
+    const fwdpy11::callback_schedule update_when(update_schedule,
+                                                 pop.generation, generations);
 
-            pop.N = N_next;
-            fwdpy11::update_mutations(
-                pop.mutations, pop.fixations, pop.fixation_times,
-                pop.mut_lookup, pop.mcounts, pop.generation, 2 * pop.N, false);
-            fitness.update(pop);
-            wbar = rules.w(pop, fitness_callback);
-            recorder(pop);
-            if (updater_exists)
-                {
-                    updater(pop);
-                }
-            if (noise_updater_exists)
-                {
-                    noise_updater_fxn(pop.generation);
-                }
-        }
+    slocus_qtrait_visitor<decltype(mmodels), decltype(recmap)> v{
+        rng, pop, popsizes, mu_neutral + mu_selected, mmodels, recmap,
+        rmodel, recrate, fitness, recorder, record_when, update_when,
+        selfing_rate, trait_to_fitness, updater, noise, noise_updater_fxn,
+        nthreads, cache_gvalues, deduplicate_gametes, batch_random_draws
+    };
+    // Built-in trait value models get their own instantiation
+    // of evolve_slocus_qtrait_common.  Everything else goes through
+    // a std::function.
+    fwdpy11::dispatch_single_locus_fitness(fitness, v);
     --pop.generation;
 }
 
@@ -149,11 +334,13 @@ evolve_qtrait_mloc_regions_cpp(
     py::list interlocus_rec_wrappers,
     // const std::vector<std::function<unsigned(void)>> &interlocus_rec,
     fwdpy11::multilocus_genetic_value &multilocus_gvalue,
-    fwdpy11::multilocus_temporal_sampler recorder, const double selfing_rate,
-    fwdpy11::multilocus_aggregator_function aggregator,
+    py::object recorder_object, const double selfing_rate,
+    py::object aggregator,
     fwdpy11::trait_to_fitness_function trait_to_fitness,
     py::object trait_to_fitness_updater,
-    fwdpy11::multilocus_noise_function noise, py::object noise_updater)
+    fwdpy11::multilocus_noise_function noise, py::object noise_updater,
+    const unsigned nthreads, py::object record_schedule,
+    py::object update_schedule, const bool parallel_offspring)
 {
     bool updater_exists = false;
     py::function updater;
@@ -172,6 +359,8 @@ evolve_qtrait_mloc_regions_cpp(
     const auto generations = popsizes.size();
     if (!generations)
         throw std::runtime_error("empty list of population sizes");
+    if (!nthreads)
+        throw std::runtime_error("number of threads must be > 0");
     auto bound_mmodels = KTfwd::extensions::bind_vec_dmm(
         mmodels, pop.mutations, pop.mut_lookup, rng.get(),
         neutral_mutation_rates, selected_mutation_rates, &pop.generation);
@@ -182,10 +371,42 @@ evolve_qtrait_mloc_regions_cpp(
                    selected_mutation_rates.cbegin(), total_mut_rates.begin(),
                    std::plus<double>());
 
-    fwdpy11::qtrait::qtrait_mloc_rules rules(aggregator, trait_to_fitness,
-                                             noise);
+    auto recorder = fwdpy11::make_temporal_sampler<fwdpy11::multilocus_t>(
+        recorder_object);
+
+    fwdpy11::qtrait::qtrait_mloc_rules rules(
+        aggregator.cast<fwdpy11::multilocus_aggregator_function>(),
+        trait_to_fitness, noise);
+    // Built-in aggregators are applied to all diploids at once,
+    // without going through NumPy.
+    rules.aggregator_kernel = fwdpy11::native_aggregator_kernel(aggregator);
+    // Unless parallel_offspring is true, offspring are generated
+    // serially and the pool is only used by rules.w().
+    std::unique_ptr<fwdpy11::thread_pool> pool(nullptr);
+    if (nthreads > 1 || parallel_offspring)
+        {
+            pool.reset(new fwdpy11::thread_pool(nthreads));
+        }
+    if (nthreads > 1)
+        rules.pool = pool.get();
+    auto thread_rngs = parallel_offspring
+                           ? fwdpy11::make_thread_rngs(rng, nthreads)
+                           : std::vector<fwdpy11::GSLrng_t>();
+    std::vector<decltype(bound_intralocus_rec)> thread_intralocus_rec;
+    for (auto &r : thread_rngs)
+        {
+            thread_intralocus_rec.emplace_back(
+                KTfwd::extensions::bind_vec_drm(rmodels, pop.gametes,
+                                                pop.mutations, r.get(),
+                                                recrates));
+        }
+    fwdpy11::offspring_staging staging;
 
     ++pop.generation;
+    const fwdpy11::callback_schedule record_when(record_schedule,
+                                                 pop.generation, generations);
+    const fwdpy11::callback_schedule update_when(update_schedule,
+                                                 pop.generation, generations);
     multilocus_gvalue.update(pop);
     auto wbar = rules.w(pop, multilocus_gvalue);
     std::vector<std::function<unsigned(void)>> interlocus_rec;
@@ -195,35 +416,55 @@ evolve_qtrait_mloc_regions_cpp(
                 py::cast<fwdpy11::interlocus_rec>(i).callback(rng));
         }
 
+    const auto pick1
+        = std::bind(&fwdpy11::qtrait::qtrait_mloc_rules::pick1, &rules,
+                    std::placeholders::_1, std::placeholders::_2);
+    const auto pick2
+        = std::bind(&fwdpy11::qtrait::qtrait_mloc_rules::pick2, &rules,
+                    std::placeholders::_1, std::placeholders::_2,
+                    std::placeholders::_3, selfing_rate);
+    const auto update
+        = std::bind(&fwdpy11::qtrait::qtrait_mloc_rules::update, &rules,
+                    std::placeholders::_1, std::placeholders::_2,
+                    std::placeholders::_3, std::placeholders::_4,
+                    std::placeholders::_5);
+
+    fwdpy11::fixation_batch fixations;
     for (unsigned i = 0; i < generations; ++i, ++pop.generation)
         {
             auto N_next = popsizes.at(i);
-            fwdpy11::evolve_generation(
-                rng, pop, N_next, total_mut_rates, bound_mmodels,
-                bound_intralocus_rec, interlocus_rec,
-                std::bind(&fwdpy11::qtrait::qtrait_mloc_rules::pick1, &rules,
-                          std::placeholders::_1, std::placeholders::_2),
-                std::bind(&fwdpy11::qtrait::qtrait_mloc_rules::pick2, &rules,
-                          std::placeholders::_1, std::placeholders::_2,
-                          std::placeholders::_3, selfing_rate),
-                std::bind(&fwdpy11::qtrait::qtrait_mloc_rules::update, &rules,
-                          std::placeholders::_1, std::placeholders::_2,
-                          std::placeholders::_3, std::placeholders::_4,
-                          std::placeholders::_5),
-                KTfwd::remove_neutral());
+            if (parallel_offspring)
+                {
+                    fwdpy11::evolve_generation_threaded(
+                        rng, *pool, thread_rngs, thread_intralocus_rec,
+                        staging, pop, N_next, total_mut_rates, bound_mmodels,
+                        interlocus_rec, pick1, pick2, update,
+                        KTfwd::remove_neutral());
+                }
+            else
+                {
+                    fwdpy11::evolve_generation(
+                        rng, pop, N_next, total_mut_rates, bound_mmodels,
+                        bound_intralocus_rec, interlocus_rec, pick1, pick2,
+                        update, KTfwd::remove_neutral());
+                }
 
             pop.N = N_next;
             fwdpy11::update_mutations(
                 pop.mutations, pop.fixations, pop.fixation_times,
-                pop.mut_lookup, pop.mcounts, pop.generation, 2 * pop.N, false);
+                pop.mut_lookup, pop.mcounts, pop.generation, 2 * pop.N, false,
+                fixations);
             multilocus_gvalue.update(pop);
             wbar = rules.w(pop, multilocus_gvalue);
-            recorder(pop);
-            if (updater_exists)
+            if (record_when(i))
+                {
+                    recorder(pop);
+                }
+            if (updater_exists && update_when(i))
                 {
                     updater(pop);
                 }
-            if (noise_updater_exists)
+            if (noise_updater_exists && update_when(i))
                 {
                     noise_updater_fxn(pop);
                 }
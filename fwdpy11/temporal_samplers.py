@@ -16,6 +16,9 @@
 # You should have received a copy of the GNU General Public License
 # along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
 #
+from .recorders import NativeRecorder, RecordMeanFitness  # NOQA
+from .recorders import RecordTraitValues, RecordSegSites  # NOQA
+from .recorders import RecordSFS, RecordFixations  # NOQA
 
 
 class RecordNothing:
@@ -52,4 +52,7 @@ def evolve(rng, pop, params, recorder=None):
                                  params.mutrate_n, params.mutrate_s,
                                  params.recrate, mm, rm,
                                  params.gvalue, recorder, params.pself,
-                                 params.prune_selected)
+                                 params.prune_selected, params.nthreads,
+                                 params.cache_gvalues, params.record_schedule,
+                                 params.deduplicate_gametes,
+                                 params.batch_random_draws)
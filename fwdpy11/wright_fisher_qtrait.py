@@ -101,7 +101,7 @@ class GaussianNoise:
         :param sd: :math:`\\sigma`
         :param mean: (0.0) :math:`\\mu`
         """
-        if(type(rng) is fwdpy11.GSLrng) is False:
+        if isinstance(rng, fwdpy11.GSLrng) is False:
             raise ValueError("rng must be a fwdpy11.GSLrng")
         self.sd = sd
         self.mean = mean
@@ -145,7 +145,12 @@ def _evolve_slocus(rng, pop, params, recorder=None):
                                         params.recrate, mm, rm,
                                         params.gvalue, recorder,
                                         params.pself, params.trait2w, updater,
-                                        params.noise, noise_updater)
+                                        params.noise, noise_updater,
+                                        params.nthreads, params.cache_gvalues,
+                                        params.record_schedule,
+                                        params.update_schedule,
+                                        params.deduplicate_gametes,
+                                        params.batch_random_draws)
 
 
 def _evolve_mlocus(rng, pop, params, recorder=None):
@@ -183,7 +188,10 @@ def _evolve_mlocus(rng, pop, params, recorder=None):
                                    params.pself,
                                    params.aggregator,
                                    params.trait2w,
-                                   updater, noise, noise_updater)
+                                   updater, noise, noise_updater,
+                                   params.nthreads, params.record_schedule,
+                                   params.update_schedule,
+                                   params.parallel_offspring)
 
 
 def evolve(rng, pop, params, recorder=None):
@@ -162,6 +162,14 @@ ext_modules = [
         libraries=['gsl', 'gslcblas'],
         language='c++'
     ),
+    Extension(
+        'fwdpy11.recorders',
+        ['fwdpy11/src/recorders.cc'],
+        library_dirs=LIBRARY_DIRS,
+        include_dirs=INCLUDES,
+        libraries=['gsl', 'gslcblas'],
+        language='c++'
+    ),
     ]
 
 
@@ -208,6 +216,7 @@ class BuildExt(build_ext):
     def build_extensions(self):
         ct = self.compiler.compiler_type
         opts = self.c_opts.get(ct, [])
+        link_opts = []
         if ct == 'unix':
             opts.append('-DVERSION_INFO="%s"' %
                         self.distribution.get_version())
@@ -219,14 +228,19 @@ class BuildExt(build_ext):
                 opts.append('-g0')
             if DEBUG_MODE is True:
                 opts.append('-UNDEBUG')
+            # Needed for the multi-threaded evolve functions
+            if has_flag(self.compiler, '-pthread'):
+                opts.append('-pthread')
+                link_opts.append('-pthread')
         elif ct == 'msvc':
             opts.append('/DVERSION_INFO=\\"%s\\"' %
                         self.distribution.get_version())
         for ext in self.extensions:
             ext.extra_compile_args = opts
+            ext.extra_link_args = list(link_opts)
             if sys.platform == 'darwin' and USE_GCC is False:
-                ext.extra_link_args = ['-stdlib=libc++',
-                                       '-mmacosx-version-min=10.7']
+                ext.extra_link_args += ['-stdlib=libc++',
+                                        '-mmacosx-version-min=10.7']
         build_ext.build_extensions(self)
 
 
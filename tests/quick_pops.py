@@ -53,7 +53,31 @@ def quick_nonneutral_slocus(N=1000, simlen=100, dfe=None):
     return pop
 
 
-def quick_mlocus_qtrait(N=1000, simlen=100):
+def quick_slocus_params(N=1000, simlen=100, rates=(1e-3, 1e-3, 1e-3),
+                        dfe=None, **kwargs):
+    """
+    Parameters for a single region with N constant for
+    simlen generations.  Other parameters may be given as
+    keyword arguments.  Returns a new object each time, so
+    that tests may modify it.
+    """
+    from fwdpy11.model_params import SlocusParams
+    from fwdpy11.regions import ExpS, Region
+    import numpy as np
+    if dfe is None:
+        dfe = ExpS(0, 1, 1, -1e-2)
+    nregions = [Region(0, 1, 1)]
+    param_dict = {'nregions': nregions,
+                  'sregions': [dfe],
+                  'recregions': nregions,
+                  'rates': rates,
+                  'demography': np.array([N] * simlen, dtype=np.uint32)}
+    param_dict.update(kwargs)
+    return SlocusParams(**param_dict)
+
+
+def quick_mlocus_qtrait(N=1000, simlen=100, nthreads=1, aggregator=None,
+                       parallel_offspring=False):
     from fwdpy11.model_params import MlocusParamsQ
     from fwdpy11 import MlocusPop, GSLrng
     from fwdpy11.wright_fisher_qtrait import evolve, GSS
@@ -76,7 +100,7 @@ def quick_mlocus_qtrait(N=1000, simlen=100):
                   for i, j in zip(range(nloci), locus_boundaries)]
     sregions = [[GaussianS(j[0] + 5., j[0] + 6., mu, sigmu, coupled=False)]
                 for i, j in zip(range(nloci), locus_boundaries)]
-    agg = AggAddTrait()
+    agg = AggAddTrait() if aggregator is None else aggregator
     interlocus_rec = binomial_rec([0.5] * (nloci - 1))
     mlv = MultiLocusGeneticValue([SlocusAdditiveTrait(2.0)] * nloci)
     nlist = np.array([N] * simlen, dtype=np.uint32)
@@ -90,7 +114,9 @@ def quick_mlocus_qtrait(N=1000, simlen=100):
                   'aggregator': agg,
                   'gvalue': mlv,
                   'trait2w': GSS(1, 0),
-                  'demography': nlist}
+                  'demography': nlist,
+                  'nthreads': nthreads,
+                  'parallel_offspring': parallel_offspring}
     params = MlocusParamsQ(**param_dict)
     pop = MlocusPop(N, nloci, locus_boundaries)
     evolve(rng, pop, params)
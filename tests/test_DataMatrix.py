@@ -109,6 +109,69 @@ class test_DataMatrixFromSlocusPop(unittest.TestCase):
             i += 1
 
 
+class test_PackedHaplotypeMatrix(unittest.TestCase):
+    @classmethod
+    def setUpClass(self):
+        self.pop = quick_nonneutral_slocus()
+        self.indlist = [i for i in range(100, 150)]
+        self.keys = fwdpy11.sampling.mutation_keys(self.pop, self.indlist)
+        self.hm = fwdpy11.sampling.haplotype_matrix(
+            self.pop, self.indlist, self.keys[0], self.keys[1])
+        self.hm_neutral = np.ndarray(
+            self.hm.ndim_neutral(),
+            buffer=self.hm.neutral, dtype=np.int8)
+        self.hm_selected = np.ndarray(
+            self.hm.ndim_selected(),
+            buffer=self.hm.selected, dtype=np.int8)
+
+    def compare(self, packed, positions, expected, expected_positions):
+        # Compare columns by position, which does not
+        # depend on the order of the columns
+        columns = {p: expected[:, i]
+                   for i, p in enumerate(expected_positions)}
+        self.assertEqual(packed.shape, expected.shape)
+        for i, p in enumerate(positions):
+            self.assertTrue(np.array_equal(packed[:, i], columns[p]))
+
+    def testUnpack(self):
+        for row_major in (True, False):
+            pm = fwdpy11.sampling.packed_haplotype_matrix(
+                self.pop, self.indlist, self.keys[0], self.keys[1],
+                row_major)
+            self.assertEqual(pm.row_major, row_major)
+            self.assertEqual(pm.ndim_neutral(), self.hm.ndim_neutral())
+            self.assertEqual(pm.ndim_selected(), self.hm.ndim_selected())
+            self.compare(pm.unpack(True), pm.neutral_positions,
+                         self.hm_neutral, self.hm.neutral_positions)
+            self.compare(pm.unpack(False), pm.selected_positions,
+                         self.hm_selected, self.hm.selected_positions)
+
+    def testWords(self):
+        pm = fwdpy11.sampling.packed_haplotype_matrix(
+            self.pop, self.indlist, self.keys[0], self.keys[1])
+        words = pm.neutral
+        self.assertEqual(words.dtype, np.uint64)
+        nrow, ncol = pm.ndim_neutral()
+        self.assertEqual(words.shape, (nrow, (ncol + 63) // 64))
+        # Bit counts per row are the numbers of neutral mutations
+        # on each haplotype
+        unpacked = pm.unpack(True)
+        bits = np.unpackbits(words.view(np.uint8), axis=1)
+        self.assertTrue(np.array_equal(bits.sum(axis=1),
+                                       unpacked.sum(axis=1)))
+
+    def testToDataMatrix(self):
+        pm = fwdpy11.sampling.packed_haplotype_matrix(
+            self.pop, self.indlist, self.keys[0], self.keys[1], False)
+        dm = pm.to_DataMatrix()
+        self.assertEqual(dm.ndim_neutral(), pm.ndim_neutral())
+        self.assertEqual(list(dm.neutral_positions),
+                         list(pm.neutral_positions))
+        neutral = np.ndarray(dm.ndim_neutral(), buffer=dm.neutral,
+                             dtype=np.int8)
+        self.assertTrue(np.array_equal(neutral, pm.unpack(True)))
+
+
 class test_DataMatrixFromMlocusPop(unittest.TestCase):
     @classmethod
     def setUpClass(self):
@@ -156,5 +219,29 @@ class test_DataMatrixFromMlocusPop(unittest.TestCase):
                 self.assertTrue(site[0] < self.pop.locus_boundaries[key][1])
                 self.assertTrue(len(site[1]) == self.gm_neutral.shape[0])
 
+    def testConvertHapMatrixToPacked(self):
+        nsample = fwdpy11.sampling.matrix_to_sample(self.hm, True)
+        pos, bits = fwdpy11.sampling.matrix_to_sample_packed(self.hm, True)
+        nrow = self.hm_neutral.shape[0]
+        genotypes = np.unpackbits(bits, axis=1)[:, :nrow]
+        self.assertEqual(len(nsample), len(pos))
+        for site, p, g in zip(nsample, pos, genotypes):
+            self.assertEqual(site[0], p)
+            self.assertEqual(site[1], ''.join(str(i) for i in g))
+        self.assertTrue(np.array_equal(genotypes, self.hm_neutral.T))
+
+    def testLocusIndexes(self):
+        nsample = fwdpy11.sampling.matrix_to_sample(self.hm, True)
+        nsample_split = fwdpy11.sampling.separate_samples_by_loci(
+            self.pop.locus_boundaries, nsample)
+        pos = np.array([i[0] for i in nsample])
+        loci = fwdpy11.sampling.locus_indexes(self.pop.locus_boundaries, pos)
+        self.assertEqual(len(loci), len(pos))
+        for key, value in nsample_split.items():
+            self.assertEqual([i[0] for i in value], list(pos[loci == key]))
+        with self.assertRaises(RuntimeError):
+            fwdpy11.sampling.locus_indexes(self.pop.locus_boundaries,
+                                           np.array([-1.0]))
+
 if __name__ == "__main__":
     unittest.main()
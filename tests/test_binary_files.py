@@ -0,0 +1,172 @@
+#
+# Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+#
+# This file is part of fwdpy11.
+#
+# fwdpy11 is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# fwdpy11 is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+#
+import unittest
+import os
+import tempfile
+import fwdpy11 as fp11
+from quick_pops import quick_nonneutral_slocus, quick_mlocus_qtrait
+
+
+class testBinaryFiles(unittest.TestCase):
+    def setUp(self):
+        fd, self.filename = tempfile.mkstemp(suffix='.fp11')
+        os.close(fd)
+
+    def tearDown(self):
+        os.remove(self.filename)
+
+    def testSlocusPop(self):
+        pop = quick_nonneutral_slocus()
+        pop.tofile(self.filename)
+        pop2 = fp11.SlocusPop.fromfile(self.filename)
+        self.assertTrue(pop == pop2)
+        self.assertEqual(pop.generation, pop2.generation)
+        self.assertEqual(pop.N, pop2.N)
+        self.assertEqual(list(pop.fixation_times),
+                         list(pop2.fixation_times))
+
+    def testMlocusPop(self):
+        pop = quick_mlocus_qtrait()
+        pop.tofile(self.filename)
+        pop2 = fp11.MlocusPop.fromfile(self.filename)
+        self.assertTrue(pop == pop2)
+        self.assertEqual(pop.generation, pop2.generation)
+        self.assertEqual(pop.nloci, pop2.nloci)
+        self.assertEqual(pop.locus_boundaries, pop2.locus_boundaries)
+
+    def testSlocusPopGeneralMutVec(self):
+        pop = fp11.SlocusPopGeneralMutVec(100)
+        pop.tofile(self.filename)
+        pop2 = fp11.SlocusPopGeneralMutVec.fromfile(self.filename)
+        self.assertTrue(pop == pop2)
+
+    def testSameAsPickle(self):
+        import pickle
+        pop = quick_nonneutral_slocus()
+        pop.tofile(self.filename)
+        pop2 = fp11.SlocusPop.fromfile(self.filename)
+        pop3 = pickle.loads(pickle.dumps(pop, -1))
+        self.assertTrue(pop2 == pop3)
+
+    def testWrongPopType(self):
+        pop = fp11.SlocusPop(100)
+        pop.tofile(self.filename)
+        with self.assertRaises(ValueError):
+            fp11.MlocusPop.fromfile(self.filename)
+
+    def testNotAPopFile(self):
+        with open(self.filename, 'w') as f:
+            f.write("This is not a population" * 10)
+        with self.assertRaises(ValueError):
+            fp11.SlocusPop.fromfile(self.filename)
+
+    def testMissingFile(self):
+        with self.assertRaises(RuntimeError):
+            fp11.SlocusPop.fromfile(self.filename + ".missing")
+
+
+def diploid_tuple(d):
+    return (d.first, d.second, d.label, d.g, d.e, d.w)
+
+
+def gamete_tuple(g):
+    return (g.n, list(g.mutations), list(g.smutations))
+
+
+class testPopulationFile(unittest.TestCase):
+    @classmethod
+    def setUpClass(self):
+        fd, self.filename = tempfile.mkstemp(suffix='.fp11')
+        os.close(fd)
+        fd, self.mlocus_filename = tempfile.mkstemp(suffix='.fp11')
+        os.close(fd)
+        self.pop = quick_nonneutral_slocus()
+        self.pop.tofile(self.filename)
+        self.mlocus_pop = quick_mlocus_qtrait()
+        self.mlocus_pop.tofile(self.mlocus_filename)
+
+    @classmethod
+    def tearDownClass(self):
+        os.remove(self.filename)
+        os.remove(self.mlocus_filename)
+
+    def testMetadata(self):
+        f = fp11.PopulationFile(self.filename)
+        self.assertEqual(f.poptype, "SlocusPop")
+        self.assertEqual(f.generation, self.pop.generation)
+        self.assertEqual(f.N, self.pop.N)
+        self.assertEqual(f.nloci, 1)
+        f = fp11.PopulationFile(self.mlocus_filename)
+        self.assertEqual(f.poptype, "MlocusPop")
+        self.assertEqual(f.nloci, self.mlocus_pop.nloci)
+
+    def testMutations(self):
+        f = fp11.PopulationFile(self.filename)
+        self.assertEqual(f.mutations(), self.pop.mutations)
+        self.assertEqual(list(f.mcounts()), list(self.pop.mcounts))
+        self.assertEqual(f.fixations(), self.pop.fixations)
+        self.assertEqual(list(f.fixation_times()),
+                         list(self.pop.fixation_times))
+
+    def testDiploids(self):
+        f = fp11.PopulationFile(self.filename)
+        self.assertEqual(f.diploids(), self.pop.diploids)
+        d = f.diploids([10, 2])
+        self.assertEqual(len(d), 2)
+        self.assertEqual(diploid_tuple(d[0]),
+                         diploid_tuple(self.pop.diploids[10]))
+        self.assertEqual(diploid_tuple(d[1]),
+                         diploid_tuple(self.pop.diploids[2]))
+        with self.assertRaises(IndexError):
+            f.diploids([self.pop.N])
+
+    def testGametes(self):
+        f = fp11.PopulationFile(self.filename)
+        g = f.gametes([5])
+        self.assertEqual(len(g), 2)
+        dip = self.pop.diploids[5]
+        self.assertEqual(gamete_tuple(g[0]),
+                         gamete_tuple(self.pop.gametes[dip.first]))
+        self.assertEqual(gamete_tuple(g[1]),
+                         gamete_tuple(self.pop.gametes[dip.second]))
+
+    def testMlocusDiploidsAndGametes(self):
+        f = fp11.PopulationFile(self.mlocus_filename)
+        d = f.diploids([3])
+        expected = self.mlocus_pop.diploids[3]
+        self.assertEqual([diploid_tuple(i) for i in d[0]],
+                         [diploid_tuple(i) for i in expected])
+        g = f.gametes([3])
+        self.assertEqual(len(g), 2 * self.mlocus_pop.nloci)
+        gametes = self.mlocus_pop.gametes
+        for i, locus in enumerate(self.mlocus_pop.diploids[3]):
+            self.assertEqual(gamete_tuple(g[2 * i]),
+                             gamete_tuple(gametes[locus.first]))
+            self.assertEqual(gamete_tuple(g[2 * i + 1]),
+                             gamete_tuple(gametes[locus.second]))
+
+    def testLoad(self):
+        f = fp11.PopulationFile(self.filename)
+        self.assertTrue(f.load() == self.pop)
+        f = fp11.PopulationFile(self.mlocus_filename)
+        self.assertTrue(f.load() == self.mlocus_pop)
+
+
+if __name__ == "__main__":
+    unittest.main()
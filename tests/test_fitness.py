@@ -2,6 +2,7 @@
 
 import unittest
 import fwdpy11
+from quick_pops import quick_slocus_params
 
 
 class testObject_repr(unittest.TestCase):
@@ -23,5 +24,52 @@ class testObject_repr(unittest.TestCase):
         self.assertEqual(type(ww), SlocusMult)
 
 
+class testBuiltinFitnessEvolve(unittest.TestCase):
+    """
+    Built-in fitness types are evaluated via a specialized
+    code path during simulation.  Check that it agrees with
+    the callback.
+    """
+    def setUp(self):
+        self.p = quick_slocus_params(N=500, simlen=50,
+                                     rates=(1e-3, 5e-3, 1e-3),
+                                     dfe=fwdpy11.ExpS(0, 1, 1, -1e-2, 0.25))
+
+    def check(self, gvalue, cache_gvalues=False):
+        from fwdpy11.wright_fisher import evolve
+        pop = fwdpy11.SlocusPop(500)
+        rng = fwdpy11.GSLrng(42)
+        self.p.gvalue = gvalue
+        self.p.cache_gvalues = cache_gvalues
+        evolve(rng, pop, self.p)
+        for dip in pop.diploids:
+            self.assertAlmostEqual(dip.w, gvalue(dip, pop))
+
+    def testSlocusMult(self):
+        from fwdpy11.fitness import SlocusMult
+        self.check(SlocusMult(2.0))
+
+    def testSlocusAdditive(self):
+        from fwdpy11.fitness import SlocusAdditive
+        self.check(SlocusAdditive(1.0))
+
+    def testSlocusMultCached(self):
+        from fwdpy11.fitness import SlocusMult
+        self.check(SlocusMult(2.0), True)
+
+    def testSlocusAdditiveCached(self):
+        from fwdpy11.fitness import SlocusAdditive
+        self.check(SlocusAdditive(1.0), True)
+
+    def testCacheRequiresBuiltinModel(self):
+        from fwdpy11.trait_values import SlocusGBRTrait
+        self.p.gvalue = SlocusGBRTrait()
+        self.p.cache_gvalues = False
+        self.p.validate()
+        self.p.cache_gvalues = True
+        with self.assertRaises(ValueError):
+            self.p.validate()
+
+
 if __name__ == "__main__":
     unittest.main()
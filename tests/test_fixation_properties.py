@@ -5,6 +5,7 @@
 import unittest
 import os
 from quick_pops import quick_nonneutral_slocus
+from quick_pops import quick_slocus_params
 from quick_pops import quick_mlocus_qtrait_change_optimum
 
 
@@ -43,6 +44,9 @@ class testFixationsAreSortedQtraitSim(unittest.TestCase):
         self.assertEqual(len(pop.fixations), len(pop.fixation_times))
         fpos = [i.pos for i in pop.fixations]
         self.assertTrue(sorted(fpos))
+        self.assertEqual(fpos, sorted(fpos))
+        # Retained fixations must only be recorded once
+        self.assertEqual(len(set(fpos)), len(fpos))
         non_neutral_fixations = [i.key for i in pop.fixations if i.neutral is False]
         # If this test fails, we have sim parameters
         # that are not useful for testing:
@@ -53,5 +57,50 @@ class testFixationsAreSortedQtraitSim(unittest.TestCase):
             self.assertTrue(any(i.key == ni for i in pop.mutations))
 
 
+class testRetainedFixationsSlocusPop(unittest.TestCase):
+    """
+    With prune_selected=False, selected fixations stay at
+    a count of 2N.  They must be recorded once, and must not
+    stop later fixations from being found.
+    """
+
+    def test_retained_fixations(self):
+        import numpy as np
+        import fwdpy11
+        from fwdpy11.wright_fisher import evolve
+        N = 100
+        p = quick_slocus_params(N=N, simlen=1000, rates=(5e-3, 5e-3, 1e-3),
+                                dfe=fwdpy11.ExpS(0, 1, 1, 0.1),
+                                prune_selected=False)
+        pop = fwdpy11.SlocusPop(N)
+        rng = fwdpy11.GSLrng(42)
+        # Two calls, so that the second one starts
+        # with retained fixations
+        evolve(rng, pop, p)
+        evolve(rng, pop, p)
+        fpos = [i.pos for i in pop.fixations]
+        self.assertEqual(len(set(fpos)), len(fpos))
+        retained = [(i.pos, t) for i, t in
+                    zip(pop.fixations, pop.fixation_times)
+                    if i.neutral is False]
+        # If this fails, the parameters are not useful for testing
+        self.assertTrue(len(retained) > 0)
+        first = min(t for i, t in retained)
+        self.assertTrue(any(t > first for i, t in
+                            zip(pop.fixations, pop.fixation_times)
+                            if i.neutral is True))
+        mc = np.array(pop.mcounts)
+        for pos, t in retained:
+            keys = [k for k, m in enumerate(pop.mutations)
+                    if m.pos == pos and mc[k] == 2 * N]
+            self.assertEqual(len(keys), 1)
+        # Neutral fixations are removed from gametes in
+        # the generation in which they fix.
+        for g in pop.gametes:
+            if g.n > 0:
+                for k in g.mutations:
+                    self.assertTrue(0 < mc[k] < 2 * N)
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -113,6 +113,95 @@ class testRecombination(unittest.TestCase):
         with self.assertWarns(DeprecationWarning):
             x = fp11m.poisson_rec(self.rng,[1e-3]*4)
 
+class testThreadedFitness(unittest.TestCase):
+    """
+    For multi-locus simulations, threads are only used
+    to calculate genetic values, so results must not
+    depend on the number of threads.
+    """
+
+    def testSameAsSerial(self):
+        from quick_pops import quick_mlocus_qtrait
+        serial = quick_mlocus_qtrait(N=500, simlen=50)
+        threaded = quick_mlocus_qtrait(N=500, simlen=50, nthreads=3)
+        self.assertTrue(serial == threaded)
+        for i, j in zip(serial.diploids, threaded.diploids):
+            self.assertEqual(i[0].g, j[0].g)
+            self.assertEqual(i[0].w, j[0].w)
+
+
+
+class testNativeAggregator(unittest.TestCase):
+    """
+    Built-in aggregators are applied without NumPy,
+    which must give the same result as calling them
+    from Python.
+    """
+
+    def testSameAsPythonAggregator(self):
+        from quick_pops import quick_mlocus_qtrait
+        agg = fp11m.AggAddTrait()
+        native = quick_mlocus_qtrait(N=500, simlen=50)
+        python = quick_mlocus_qtrait(N=500, simlen=50,
+                                     aggregator=lambda x: agg(x))
+        self.assertTrue(native == python)
+        for i, j in zip(native.diploids, python.diploids):
+            self.assertEqual(i[0].g, j[0].g)
+            self.assertEqual(i[0].w, j[0].w)
+
+
+class testOffspringGametes(unittest.TestCase):
+    """
+    Offspring are generated in place, re-using the
+    storage of the previous generation.  Gamete
+    counts must still be consistent at each locus.
+    """
+
+    def testGameteCounts(self):
+        from quick_pops import quick_mlocus_qtrait
+        pop = quick_mlocus_qtrait(N=500, simlen=50)
+        self.assertEqual(len(pop.diploids), 500)
+        nloci = len(pop.diploids[0])
+        counts = {}
+        for dip in pop.diploids:
+            self.assertEqual(len(dip), nloci)
+            for locus in dip:
+                for g in (locus.first, locus.second):
+                    counts[g] = counts.get(g, 0) + 1
+        for key, value in counts.items():
+            self.assertEqual(pop.gametes[key].n, value)
+        self.assertEqual(sum(counts.values()), 2 * 500 * nloci)
+
+
+class testParallelOffspring(unittest.TestCase):
+    """
+    When offspring are generated in parallel, results
+    are reproducible for a given number of threads.
+    """
+
+    def testReproducible(self):
+        from quick_pops import quick_mlocus_qtrait
+        pop1 = quick_mlocus_qtrait(N=500, simlen=50, nthreads=3,
+                                   parallel_offspring=True)
+        pop2 = quick_mlocus_qtrait(N=500, simlen=50, nthreads=3,
+                                   parallel_offspring=True)
+        self.assertTrue(pop1 == pop2)
+        for i, j in zip(pop1.diploids, pop2.diploids):
+            self.assertEqual(i[0].g, j[0].g)
+            self.assertEqual(i[0].w, j[0].w)
+
+    def testGameteCounts(self):
+        from quick_pops import quick_mlocus_qtrait
+        pop = quick_mlocus_qtrait(N=500, simlen=50, nthreads=3,
+                                  parallel_offspring=True)
+        counts = {}
+        for dip in pop.diploids:
+            for locus in dip:
+                for g in (locus.first, locus.second):
+                    counts[g] = counts.get(g, 0) + 1
+        for key, value in counts.items():
+            self.assertEqual(pop.gametes[key].n, value)
+
 if __name__ == "__main__":
     unittest.main()
 
@@ -53,6 +53,43 @@ class test_SlocusPop(unittest.TestCase):
             self.assertEqual(i['first'], j.first)
             self.assertEqual(i['second'], j.second)
 
+    def testDiploidView(self):
+        v = self.pop.diploids.view()
+        self.assertFalse(v.flags.writeable)
+        self.assertEqual(len(v), len(self.pop.diploids))
+        for i, j in zip(v, self.pop.diploids):
+            self.assertEqual(i['first'], j.first)
+            self.assertEqual(i['second'], j.second)
+            self.assertEqual(i['label'], j.label)
+            self.assertEqual(i['g'], j.g)
+            self.assertEqual(i['e'], j.e)
+            self.assertEqual(i['w'], j.w)
+
+    def testMutationView(self):
+        v = self.pop.mutations.view()
+        self.assertFalse(v.flags.writeable)
+        self.assertEqual(len(v), len(self.pop.mutations))
+        for i, j in zip(v, self.pop.mutations):
+            self.assertEqual(i['neutral'], j.neutral)
+            self.assertEqual(i['h'], j.h)
+            self.assertEqual(i['pos'], j.pos)
+            self.assertEqual(i['g'], j.g)
+            self.assertEqual(i['s'], j.s)
+            self.assertEqual(i['label'], j.label)
+
+    def testMcountsView(self):
+        v = self.pop.mcounts.view()
+        self.assertFalse(v.flags.writeable)
+        self.assertTrue(np.array_equal(v, np.array(self.pop.mcounts)))
+
+    def testViewOutlivesPop(self):
+        from quick_pops import quick_nonneutral_slocus
+        pop = quick_nonneutral_slocus()
+        v = pop.diploids.view()
+        w = np.array([i.w for i in pop.diploids])
+        del pop
+        self.assertTrue(np.array_equal(v['w'], w))
+
 
 class test_MlocusPop(unittest.TestCase):
     """
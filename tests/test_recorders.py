@@ -0,0 +1,188 @@
+#
+# Copyright (C) 2017 Kevin Thornton <krthornt@uci.edu>
+#
+# This file is part of fwdpy11.
+#
+# fwdpy11 is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# fwdpy11 is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with fwdpy11.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+import unittest
+import numpy as np
+import fwdpy11
+import fwdpy11.temporal_samplers as ts
+from quick_pops import quick_slocus_params
+
+
+class testNativeRecorders(unittest.TestCase):
+    def evolve(self, recorder):
+        from fwdpy11.wright_fisher import evolve
+        p = quick_slocus_params(N=500, dfe=fwdpy11.ExpS(0, 1, 1, 1e-3),
+                                prune_selected=False)
+        pop = fwdpy11.SlocusPop(500)
+        rng = fwdpy11.GSLrng(42)
+        evolve(rng, pop, p, recorder)
+        return pop
+
+    def segsites(self, pop):
+        mc = np.array(pop.mcounts)
+        return np.where((mc > 0) & (mc < 2 * pop.N))[0]
+
+    def testInterval(self):
+        r = ts.RecordMeanFitness(10)
+        self.evolve(r)
+        d = np.array(r.data, copy=False)
+        self.assertEqual(len(d), 10)
+        self.assertTrue(np.array_equal(d['generation'],
+                                       np.arange(10, 101, 10)))
+
+    def testMeanFitness(self):
+        r = ts.RecordMeanFitness(10, 10)
+        pop = self.evolve(r)
+        d = np.array(r.data, copy=False)
+        w = np.array(pop.diploids.trait_array())['w']
+        self.assertAlmostEqual(d['wbar'][-1], w.mean())
+
+    def testTraitValues(self):
+        r = ts.RecordTraitValues(25)
+        pop = self.evolve(r)
+        d = np.array(r.data, copy=False)
+        self.assertEqual(len(d), 4)
+        g = np.array(pop.diploids.trait_array())['g']
+        self.assertAlmostEqual(d['mean'][-1], g.mean())
+        self.assertAlmostEqual(d['variance'][-1], g.var())
+
+    def testSegSites(self):
+        r = ts.RecordSegSites(50)
+        pop = self.evolve(r)
+        d = np.array(r.data, copy=False)
+        self.assertEqual(len(d), 2)
+        idx = self.segsites(pop)
+        nneutral = sum([1 for i in idx if pop.mutations[i].neutral])
+        self.assertEqual(d['neutral'][-1], nneutral)
+        self.assertEqual(d['selected'][-1], len(idx) - nneutral)
+
+    def testSFS(self):
+        r = ts.RecordSFS(50, 2 * 500 - 1)
+        pop = self.evolve(r)
+        self.assertEqual(r.counts.shape, (2, r.nbins))
+        self.assertTrue(np.array_equal(r.generations, [50, 100]))
+        mc = np.array(pop.mcounts)[self.segsites(pop)]
+        expected = np.bincount(mc - 1, minlength=r.nbins)
+        self.assertTrue(np.array_equal(r.counts[-1], expected))
+
+    def testFixations(self):
+        from fwdpy11.wright_fisher import evolve
+        # A small population with a high mutation rate, so
+        # that there are many fixations, most of which are
+        # not at the end of pop.fixations when they happen.
+        p = quick_slocus_params(N=50, simlen=1000, rates=(0.05, 0., 1e-3),
+                                sregions=[])
+        pop = fwdpy11.SlocusPop(50)
+        r = ts.RecordFixations(7)
+        evolve(fwdpy11.GSLrng(42), pop, p, r)
+        self.assertTrue(len(pop.fixations) > 10)
+        d = np.array(r.data, copy=False)
+        # Fixations after the last sample are not recorded
+        last = 7 * (1000 // 7)
+        expected = sorted((j, i.pos) for i, j in
+                          zip(pop.fixations, pop.fixation_times)
+                          if j <= last)
+        recorded = [(i['generation'], i['pos']) for i in d]
+        self.assertEqual(len(recorded), len(set(recorded)))
+        self.assertEqual(sorted(recorded), expected)
+        # Records are in order of fixation time
+        self.assertTrue(np.all(np.diff(d['generation']) >= 0))
+
+    def testInvalidInterval(self):
+        with self.assertRaises(ValueError):
+            ts.RecordMeanFitness(0)
+
+
+class RecordGenerations(object):
+    def __init__(self):
+        self.generations = []
+
+    def __call__(self, pop):
+        self.generations.append(pop.generation)
+
+
+class UpdatedTrait2W(object):
+    def __init__(self):
+        self.generations = []
+
+    def __call__(self, g, e):
+        return 1.0
+
+    def update(self, pop):
+        self.generations.append(pop.generation)
+
+
+class testSchedules(unittest.TestCase):
+    def setUp(self):
+        self.p = quick_slocus_params(N=100, simlen=50)
+
+    def evolve(self, schedule):
+        from fwdpy11.wright_fisher import evolve
+        pop = fwdpy11.SlocusPop(100)
+        rng = fwdpy11.GSLrng(42)
+        r = RecordGenerations()
+        self.p.record_schedule = schedule
+        evolve(rng, pop, self.p, r)
+        return r.generations
+
+    def testDefault(self):
+        self.assertEqual(self.evolve(None), list(range(1, 51)))
+
+    def testStride(self):
+        self.assertEqual(self.evolve(10), [10, 20, 30, 40, 50])
+
+    def testList(self):
+        self.assertEqual(self.evolve([5, 25, 500]), [5, 25])
+
+    def testBoolArray(self):
+        s = np.array([False] * 50)
+        s[[0, 49]] = True
+        self.assertEqual(self.evolve(s), [1, 50])
+
+    def testBoolArrayWrongLength(self):
+        with self.assertRaises(ValueError):
+            self.evolve(np.array([True] * 10))
+
+    def testInvalid(self):
+        with self.assertRaises(ValueError):
+            self.p.record_schedule = 0
+        with self.assertRaises(ValueError):
+            self.p.record_schedule = [-1]
+        with self.assertRaises(ValueError):
+            self.p.update_schedule = 1.5
+
+    def testUpdateSchedule(self):
+        from fwdpy11.model_params import SlocusParamsQ
+        from fwdpy11.trait_values import SlocusAdditiveTrait
+        from fwdpy11.wright_fisher_qtrait import evolve
+        t2w = UpdatedTrait2W()
+        p = SlocusParamsQ(nregions=self.p.nregions, sregions=self.p.sregions,
+                          recregions=self.p.recregions,
+                          rates=(1e-3, 1e-3, 1e-3),
+                          demography=self.p.demography,
+                          gvalue=SlocusAdditiveTrait(2.0),
+                          trait2w=t2w, update_schedule=25)
+        pop = fwdpy11.SlocusPop(100)
+        rng = fwdpy11.GSLrng(42)
+        evolve(rng, pop, p)
+        self.assertEqual(t2w.generations, [25, 50])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,65 @@
+import unittest
+import fwdpy11 as fp11
+import fwdpy11.gsl_random as gsl
+from quick_pops import quick_slocus_params
+
+
+class testXoshiro256(unittest.TestCase):
+    def testIsGSLrng(self):
+        rng = fp11.Xoshiro256(42)
+        self.assertTrue(isinstance(rng, fp11.GSLrng))
+        x = gsl.gsl_rng_uniform(rng)
+        self.assertTrue(x >= 0.0 and x < 1.0)
+
+    def testReproducible(self):
+        a = fp11.Xoshiro256(42)
+        b = fp11.Xoshiro256(42)
+        self.assertEqual([gsl.gsl_rng_uniform(a) for i in range(10)],
+                         [gsl.gsl_rng_uniform(b) for i in range(10)])
+
+    def testSubstreams(self):
+        rng = fp11.Xoshiro256(42)
+        s = rng.substreams(3)
+        self.assertEqual(len(s), 3)
+        x = [gsl.gsl_rng_uniform(i) for i in s + [rng]]
+        self.assertEqual(len(set(x)), 4)
+
+
+class testBlocks(unittest.TestCase):
+    def testUniformBlock(self):
+        for T in (fp11.GSLrng, fp11.Xoshiro256):
+            a = T(101)
+            b = T(101)
+            x = gsl.uniform_block(a, 100)
+            self.assertEqual(len(x), 100)
+            self.assertEqual(list(x),
+                             [gsl.gsl_rng_uniform(b) for i in range(100)])
+
+    def testGaussianBlock(self):
+        for T in (fp11.GSLrng, fp11.Xoshiro256):
+            a = T(101)
+            b = T(101)
+            x = gsl.gaussian_block(a, 0.5, 100)
+            self.assertEqual(list(x),
+                             [gsl.gsl_ran_gaussian_ziggurat(b, 0.5)
+                              for i in range(100)])
+
+
+class testEvolveXoshiro256(unittest.TestCase):
+    def testReproducible(self):
+        from fwdpy11.wright_fisher import evolve
+        for nthreads in (1, 4):
+            pops = []
+            for i in range(2):
+                pop = fp11.SlocusPop(1000)
+                rng = fp11.Xoshiro256(42)
+                evolve(rng, pop, quick_slocus_params(nthreads=nthreads))
+                self.assertEqual(pop.generation, 100)
+                self.assertEqual(sum([g.n for g in pop.gametes]),
+                                 2 * pop.N)
+                pops.append(pop)
+            self.assertTrue(pops[0] == pops[1])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,76 @@
+import unittest
+import fwdpy11 as fp11
+import fwdpy11.sampling
+import numpy as np
+from quick_pops import quick_neutral_slocus, quick_nonneutral_slocus
+from quick_pops import quick_mlocus_qtrait
+
+
+def unpack(packed, n):
+    """
+    Convert the output of sample_separate_packed
+    into the format returned by sample_separate.
+    """
+    pos, bits = packed
+    genotypes = np.unpackbits(bits, axis=1)[:, :n]
+    return [(p, ''.join(str(i) for i in row))
+            for p, row in zip(pos, genotypes)]
+
+
+class testSampleSeparatePacked(unittest.TestCase):
+    @classmethod
+    def setUpClass(self):
+        self.pop = quick_nonneutral_slocus()
+        self.mpop = quick_mlocus_qtrait()
+        self.indlist = [i for i in range(100, 150)]
+
+    def compare(self, pop, removeFixed, indlist=None):
+        if indlist is None:
+            indlist = self.indlist
+        s = fwdpy11.sampling.sample_separate(pop, indlist, removeFixed)
+        p = fwdpy11.sampling.sample_separate_packed(pop, indlist,
+                                                    removeFixed)
+        n = 2 * len(indlist)
+        for i in range(2):
+            self.assertEqual(p[i][0].dtype, np.float64)
+            self.assertEqual(p[i][1].dtype, np.uint8)
+            self.assertEqual(p[i][1].shape, (len(s[i]), (n + 7) // 8))
+            self.assertEqual(sorted(s[i]), unpack(p[i], n))
+
+    def testSlocusPop(self):
+        self.compare(self.pop, True)
+        self.compare(self.pop, False)
+
+    def testFixations(self):
+        # A small population, so that there are fixations,
+        # which are included when removeFixed is False.
+        pop = quick_neutral_slocus(N=50, simlen=500)
+        self.assertTrue(len(pop.fixations) > 0)
+        indlist = [i for i in range(10, 35)]
+        self.compare(pop, True, indlist)
+        self.compare(pop, False, indlist)
+        p = fwdpy11.sampling.sample_separate_packed(pop, indlist, False)
+        pos = list(p[0][0])
+        for f in pop.fixations:
+            self.assertTrue(f.pos in pos)
+
+    def testMlocusPop(self):
+        self.compare(self.mpop, True)
+        self.compare(self.mpop, False)
+
+    def testRandomSample(self):
+        rng = fp11.GSLrng(101)
+        p = fwdpy11.sampling.sample_separate_packed(rng, self.pop, 20)
+        self.assertEqual(p[0][1].shape[1], 3)
+        self.assertTrue(all(np.diff(p[0][0]) >= 0.))
+        with self.assertRaises(ValueError):
+            fwdpy11.sampling.sample_separate_packed(rng, self.pop, 21)
+
+    def testBadIndex(self):
+        with self.assertRaises(ValueError):
+            fwdpy11.sampling.sample_separate_packed(self.pop,
+                                                    [len(self.pop.diploids)])
+
+
+if __name__ == "__main__":
+    unittest.main()
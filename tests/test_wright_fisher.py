@@ -5,6 +5,7 @@ import pyximport
 import numpy as np
 pyximport.install(setup_args={'include_dirs': np.get_include()})
 from MeanFitness import MeanFitness
+from quick_pops import quick_slocus_params
 
 
 class GenerationRecorder(object):
@@ -41,6 +42,28 @@ class testWFevolve(unittest.TestCase):
                          [i + 1 for i in range(124)])
 
 
+class testCountsAcrossCalls(unittest.TestCase):
+    def testCounts(self):
+        from fwdpy11.wright_fisher import evolve
+        p = quick_slocus_params(N=500, simlen=10)
+        pop = fp11.SlocusPop(500)
+        rng = fp11.GSLrng(202)
+        # Recycling bins are rebuilt by each call to evolve.
+        for i in range(10):
+            evolve(rng, pop, p)
+            gcounts = [0] * len(pop.gametes)
+            for d in pop.diploids:
+                gcounts[d.first] += 1
+                gcounts[d.second] += 1
+            self.assertEqual(gcounts, [g.n for g in pop.gametes])
+            mcounts = [0] * len(pop.mutations)
+            for g in pop.gametes:
+                for k in list(g.mutations) + list(g.smutations):
+                    mcounts[k] += g.n
+            self.assertEqual(mcounts, list(pop.mcounts))
+        self.assertEqual(pop.generation, 100)
+
+
 class testCythonRecorder(unittest.TestCase):
     @classmethod
     def setUpClass(self):
@@ -59,6 +82,134 @@ class testCythonRecorder(unittest.TestCase):
         from fwdpy11.wright_fisher import evolve
         evolve(self.rng, self.pop, self.p, self.cython_recorder)
 
+
+class testThreadedEvolve(unittest.TestCase):
+    def setUp(self):
+        self.p = quick_slocus_params(nthreads=4)
+
+    def testReproducible(self):
+        from fwdpy11.wright_fisher import evolve
+        pops = []
+        for i in range(2):
+            pop = fp11.SlocusPop(1000)
+            rng = fp11.GSLrng(42)
+            evolve(rng, pop, self.p)
+            self.assertEqual(pop.generation, 100)
+            pops.append(pop)
+        self.assertTrue(pops[0] == pops[1])
+
+    def testGameteCounts(self):
+        from fwdpy11.wright_fisher import evolve
+        pop = fp11.SlocusPop(1000)
+        rng = fp11.GSLrng(101)
+        evolve(rng, pop, self.p)
+        self.assertEqual(sum([g.n for g in pop.gametes]), 2 * pop.N)
+
+    def testInvalidNthreads(self):
+        with self.assertRaises(ValueError):
+            self.p.nthreads = 0
+
+
+class testDeduplicateGametes(unittest.TestCase):
+    def params(self, nthreads=1, deduplicate_gametes=True):
+        return quick_slocus_params(rates=(1e-3, 1e-3, 5e-2),
+                                   nthreads=nthreads,
+                                   deduplicate_gametes=deduplicate_gametes)
+
+    def evolve(self, p, seed=101):
+        from fwdpy11.wright_fisher import evolve
+        pop = fp11.SlocusPop(1000)
+        rng = fp11.GSLrng(seed)
+        evolve(rng, pop, p)
+        self.assertEqual(pop.generation, 100)
+        return pop
+
+    def extant(self, pop):
+        return [(tuple(g.mutations), tuple(g.smutations))
+                for g in pop.gametes if g.n > 0]
+
+    def genotypes(self, pop):
+        def positions(g):
+            return sorted(pop.mutations[k].pos for k in
+                          list(pop.gametes[g].mutations) +
+                          list(pop.gametes[g].smutations))
+        return [(positions(d.first), positions(d.second))
+                for d in pop.diploids]
+
+    def testGameteCounts(self):
+        for nthreads in (1, 3):
+            pop = self.evolve(self.params(nthreads))
+            self.assertEqual(sum([g.n for g in pop.gametes]), 2 * pop.N)
+            counts = [0] * len(pop.gametes)
+            for d in pop.diploids:
+                counts[d.first] += 1
+                counts[d.second] += 1
+            self.assertEqual(counts, [g.n for g in pop.gametes])
+
+    def testNoIdenticalGametes(self):
+        for nthreads in (1, 3):
+            extant = self.extant(self.evolve(self.params(nthreads)))
+            self.assertEqual(len(extant), len(set(extant)))
+
+    def testFewerGametes(self):
+        # With more than one thread, de-duplication is the only
+        # difference between these runs, so offspring genotypes
+        # are the same.
+        pops = [self.evolve(self.params(3, i)) for i in (True, False)]
+        extant = [self.extant(pop) for pop in pops]
+        self.assertTrue(len(extant[0]) < len(extant[1]))
+        # If this fails, the parameters are not useful for testing
+        self.assertTrue(len(set(extant[1])) < len(extant[1]))
+        self.assertEqual(self.genotypes(pops[0]), self.genotypes(pops[1]))
+
+    def testReproducible(self):
+        pops = [self.evolve(self.params(), 42) for i in range(2)]
+        self.assertTrue(pops[0] == pops[1])
+
+
+class testBatchRandomDraws(unittest.TestCase):
+    def params(self, nthreads=1):
+        return quick_slocus_params(nthreads=nthreads, pself=0.25,
+                                   batch_random_draws=True)
+
+    def testReproducible(self):
+        from fwdpy11.wright_fisher import evolve
+        for nthreads in (1, 3):
+            pops = []
+            for i in range(2):
+                pop = fp11.SlocusPop(1000)
+                rng = fp11.GSLrng(42)
+                evolve(rng, pop, self.params(nthreads))
+                self.assertEqual(pop.generation, 100)
+                self.assertEqual(sum([g.n for g in pop.gametes]),
+                                 2 * pop.N)
+                pops.append(pop)
+            self.assertTrue(pops[0] == pops[1])
+
+    def testMutationsArise(self):
+        from fwdpy11.wright_fisher import evolve
+        pop = fp11.SlocusPop(1000)
+        rng = fp11.GSLrng(101)
+        evolve(rng, pop, self.params())
+        self.assertTrue(len(pop.mutations) > 0)
+        self.assertTrue(any([i > 0 for i in pop.mcounts]))
+
+
+class testNeutralFitness(unittest.TestCase):
+    def testFitnessIsOne(self):
+        from fwdpy11.wright_fisher import evolve
+        for nthreads in (1, 3):
+            p = quick_slocus_params(rates=(1e-2, 0.0, 1e-3),
+                                    nthreads=nthreads)
+            pop = fp11.SlocusPop(1000)
+            rng = fp11.GSLrng(42)
+            evolve(rng, pop, p)
+            self.assertEqual(pop.generation, 100)
+            self.assertTrue(len(pop.mutations) > 0)
+            self.assertEqual(sum([g.n for g in pop.gametes]), 2 * pop.N)
+            self.assertTrue(all([d.w == 1.0 for d in pop.diploids]))
+
+
 if __name__ == "__main__":
     unittest.main()
 